@@ -0,0 +1,35 @@
+#!/bin/bash
+# Generates a large Nash program and reports the compiler's phase timings on it.
+# Usage: ./bench.sh [function count]
+functions=${1:-20000}
+input=$(mktemp --suffix=.nash)
+output=$(mktemp)
+trap 'rm -f "$input" "$output" "$output.asm"' EXIT
+
+awk -v count="$functions" 'BEGIN {
+    for (i = 0; i < count; i++) {
+        printf "function f%d(n: int): int {\n", i
+        printf "    if (n <= 1) {\n        return 1;\n    }\n"
+        printf "    let y: int = n * f%d(n - 1) + 3 * (n - 2);\n", i
+        printf "    printInteger(y);\n    return y;\n}\n"
+    }
+    printf "function main(): void {\n"
+    for (i = 0; i < count; i++) {
+        printf "    printInteger(f%d(5));\n", i
+    }
+    printf "}\n"
+}' > "$input"
+
+echo "$(wc -c < "$input") bytes, $functions functions"
+for simd in scalar sse2 avx2; do
+    ./nashc tokens "$input" --simd=$simd --stats > /dev/null
+done
+for threads in 1 2 4 8; do
+    ./nashc tokens "$input" -j $threads --stats > /dev/null
+done
+for threads in 1 2 4 8; do
+    ./nashc ast "$input" -j $threads --stats > /dev/null
+done
+for threads in 1 2 4 8; do
+    ./nashc build "$input" -o "$output" -j $threads --stats 2>&1 | grep Generating
+done
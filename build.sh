@@ -1,3 +1,4 @@
 #!/bin/bash
 flags=("-g" "-std=c11" "-Wall" "-funsigned-char")
-gcc ${flags} src/*.c -o nashc
+gcc ${flags} -pthread src/*.c -o nashc
+./nashc runtime -o runtime.o
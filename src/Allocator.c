@@ -0,0 +1,80 @@
+#include "Allocator.h"
+
+// Caller-saved registers are preferred for values that don't cross calls, so callee-saved ones need saving less.
+static const Register ALLOCATION_ORDER[] = {
+    REGISTER_RSI, REGISTER_RDI, REGISTER_R8, REGISTER_R9, REGISTER_R10, REGISTER_R11,
+    REGISTER_RBX, REGISTER_R12, REGISTER_R13, REGISTER_R14, REGISTER_R15,
+};
+#define ALLOCATION_ORDER_COUNT (sizeof(ALLOCATION_ORDER) / sizeof(ALLOCATION_ORDER[0]))
+
+Allocation allocateRegisters(LiveInterval* intervals, uint32_t count) {
+    Allocation allocation = { 0 };
+    // Intervals holding a register, sorted by End. There are never more than there are registers.
+    uint32_t active[ALLOCATION_ORDER_COUNT];
+    uint32_t activeCount = 0;
+    uint32_t freeRegisters = ALLOCATABLE_REGISTERS;
+
+    for (uint32_t i = 0; i < count; i++) {
+        LiveInterval* interval = &intervals[i];
+
+        // Registers of intervals that ended by the time this one starts are free again.
+        uint32_t expired = 0;
+        while (expired < activeCount && intervals[active[expired]].End <= interval->Start) {
+            freeRegisters |= REGISTER_MASK(intervals[active[expired]].Register);
+            expired++;
+        }
+        for (uint32_t j = expired; j < activeCount; j++) {
+            active[j - expired] = active[j];
+        }
+        activeCount -= expired;
+
+        uint32_t allowed = interval->CrossesCall ? CALLEE_SAVED_REGISTERS : ALLOCATABLE_REGISTERS;
+        interval->Register = REGISTER_NONE;
+        if (interval->Hint != REGISTER_NONE && (freeRegisters & allowed & REGISTER_MASK(interval->Hint))) {
+            interval->Register = interval->Hint;
+        }
+        if (interval->Register == REGISTER_NONE && interval->Source != INTERVAL_NONE
+            && (freeRegisters & allowed & REGISTER_MASK(intervals[interval->Source].Register))) {
+            interval->Register = intervals[interval->Source].Register;
+        }
+        for (uint32_t j = 0; j < ALLOCATION_ORDER_COUNT && interval->Register == REGISTER_NONE; j++) {
+            if (freeRegisters & allowed & REGISTER_MASK(ALLOCATION_ORDER[j])) {
+                interval->Register = ALLOCATION_ORDER[j];
+            }
+        }
+
+        if (interval->Register == REGISTER_NONE) {
+            // Take the register of the active interval that ends last, if it ends after this one.
+            uint32_t victim = activeCount;
+            for (uint32_t j = activeCount; j-- > 0;) {
+                if (allowed & REGISTER_MASK(intervals[active[j]].Register)) {
+                    victim = j;
+                    break;
+                }
+            }
+            if (victim == activeCount || intervals[active[victim]].End <= interval->End) {
+                interval->Slot = allocation.SlotCount++;
+                continue;
+            }
+
+            LiveInterval* spilled = &intervals[active[victim]];
+            interval->Register = spilled->Register;
+            spilled->Register = REGISTER_NONE;
+            spilled->Slot = allocation.SlotCount++;
+            for (uint32_t j = victim + 1; j < activeCount; j++) {
+                active[j - 1] = active[j];
+            }
+            activeCount--;
+        }
+
+        freeRegisters &= ~REGISTER_MASK(interval->Register);
+        allocation.UsedRegisters |= REGISTER_MASK(interval->Register);
+        uint32_t position = activeCount++;
+        while (position > 0 && intervals[active[position - 1]].End > interval->End) {
+            active[position] = active[position - 1];
+            position--;
+        }
+        active[position] = i;
+    }
+    return allocation;
+}
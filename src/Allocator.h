@@ -0,0 +1,54 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include "Common.h"
+#include "Emitter.h"
+
+// Location of a value that lives in a stack slot instead of a register.
+#define REGISTER_NONE REGISTER_COUNT
+
+#define INTERVAL_NONE UINT32_MAX
+
+#define REGISTER_MASK(r) (1u << (r))
+
+// Registers values can be allocated to. rax, rcx and rdx stay free for evaluating expressions, division and calls.
+#define ALLOCATABLE_REGISTERS (REGISTER_MASK(REGISTER_RBX) | REGISTER_MASK(REGISTER_RSI) | REGISTER_MASK(REGISTER_RDI) \
+        | REGISTER_MASK(REGISTER_R8) | REGISTER_MASK(REGISTER_R9) | REGISTER_MASK(REGISTER_R10) | REGISTER_MASK(REGISTER_R11) \
+        | REGISTER_MASK(REGISTER_R12) | REGISTER_MASK(REGISTER_R13) | REGISTER_MASK(REGISTER_R14) | REGISTER_MASK(REGISTER_R15))
+// The allocatable registers a call leaves untouched.
+#define CALLEE_SAVED_REGISTERS (REGISTER_MASK(REGISTER_RBX) | REGISTER_MASK(REGISTER_R12) | REGISTER_MASK(REGISTER_R13) \
+        | REGISTER_MASK(REGISTER_R14) | REGISTER_MASK(REGISTER_R15))
+
+/*
+    The positions from the definition of a value to its last use, in the order its function's code is generated.
+    A value that is live across a call can only be kept in a callee-saved register or a stack slot. A value can
+    share the register of one whose last use is where it is defined, since instructions read their operands before
+    writing their result.
+*/
+typedef struct LiveInterval {
+    uint32_t Start;
+    uint32_t End;
+    bool CrossesCall;
+    // Register the value should get if it is free, such as the one a parameter arrives in, or REGISTER_NONE.
+    Register Hint;
+    // Earlier interval whose register the value should take over, such as the first operand of a two-address
+    // instruction, or INTERVAL_NONE.
+    uint32_t Source;
+    // Set by allocateRegisters: a register, or REGISTER_NONE and the stack slot the value is spilled to.
+    Register Register;
+    uint32_t Slot;
+} LiveInterval;
+
+typedef struct Allocation {
+    uint32_t SlotCount;
+    // Mask of the registers given to at least one value.
+    uint32_t UsedRegisters;
+} Allocation;
+
+/*
+    Give every interval a register or a stack slot with linear scan. Intervals must be sorted by Start. When the
+    registers run out, the value whose interval ends last is spilled, so the values used soonest stay in registers.
+*/
+Allocation allocateRegisters(LiveInterval* intervals, uint32_t count);
+
+#endif
@@ -0,0 +1,98 @@
+#include "Arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+
+struct ArenaChunk {
+    ArenaChunk* Previous;
+    size_t Capacity;
+    size_t Used;
+    alignas(max_align_t) uint8_t Memory[];
+};
+
+#define ARENA_ALIGNMENT alignof(max_align_t)
+
+static size_t alignUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/*
+    Chunks come from calloc and memory is never handed out twice, so every allocation is already zeroed.
+*/
+static ArenaChunk* newArenaChunk(Arena* arena, size_t capacity) {
+    ArenaChunk* chunk = calloc(1, sizeof(ArenaChunk) + capacity);
+    if (!chunk) return NULL;
+
+    chunk->Capacity = capacity;
+    arena->BytesReserved += capacity;
+    arena->ChunkCount++;
+    return chunk;
+}
+
+Arena* newArena(size_t chunkSize) {
+    Arena* arena = calloc(1, sizeof(Arena));
+    if (!arena) return NULL;
+
+    arena->ChunkSize = chunkSize ? alignUp(chunkSize, ARENA_ALIGNMENT) : ARENA_DEFAULT_CHUNK_SIZE;
+    return arena;
+}
+
+void freeArena(Arena* arena) {
+    if (!arena) return;
+
+    ArenaChunk* chunk = arena->Chunk;
+    while (chunk) {
+        ArenaChunk* previous = chunk->Previous;
+        free(chunk);
+        chunk = previous;
+    }
+    free(arena);
+}
+
+void* arenaAllocate(Arena* arena, size_t size) {
+    size = alignUp(size ? size : 1, ARENA_ALIGNMENT);
+
+    ArenaChunk* chunk = arena->Chunk;
+    if (!chunk || chunk->Used + size > chunk->Capacity) {
+        if (size > arena->ChunkSize / 4) {
+            // Large allocations get a chunk of their own, kept behind the current one so its free space isn't wasted.
+            ArenaChunk* large = newArenaChunk(arena, size);
+            if (!large) return NULL;
+
+            if (chunk) {
+                large->Previous = chunk->Previous;
+                chunk->Previous = large;
+            } else {
+                arena->Chunk = large;
+            }
+            large->Used = size;
+            arena->AllocationCount++;
+            arena->BytesAllocated += size;
+            return large->Memory;
+        }
+
+        chunk = newArenaChunk(arena, arena->ChunkSize);
+        if (!chunk) return NULL;
+        chunk->Previous = arena->Chunk;
+        arena->Chunk = chunk;
+    }
+
+    void* memory = chunk->Memory + chunk->Used;
+    chunk->Used += size;
+    arena->AllocationCount++;
+    arena->BytesAllocated += size;
+    return memory;
+}
+
+void* arenaCopy(Arena* arena, const void* data, size_t size) {
+    void* memory = arenaAllocate(arena, size);
+    if (memory && size) {
+        memcpy(memory, data, size);
+    }
+    return memory;
+}
+
+void printArenaStatistics(FILE* stream, const char* name, Arena* arena) {
+    fprintf(stream, "%s: %zu allocations, %zu bytes allocated, %zu bytes reserved in %zu chunks\n",
+        name, arena->AllocationCount, arena->BytesAllocated, arena->BytesReserved, arena->ChunkCount);
+}
@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "Common.h"
+#include <stdio.h>
+
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct Arena {
+    ArenaChunk* Chunk;
+    size_t ChunkSize;
+
+    size_t AllocationCount;
+    size_t BytesAllocated;
+    size_t BytesReserved;
+    size_t ChunkCount;
+} Arena;
+
+/*
+    Allocate a new arena that grows in chunks of at least chunkSize bytes.
+
+    Returns NULL on failure.
+*/
+Arena* newArena(size_t chunkSize);
+
+/*
+    Free an arena and every allocation made from it.
+
+    Does nothing when arena is NULL.
+*/
+void freeArena(Arena* arena);
+
+/*
+    Allocate size bytes of zeroed memory from the arena, aligned for any type.
+
+    Returns NULL on failure.
+*/
+void* arenaAllocate(Arena* arena, size_t size);
+
+/*
+    Copy size bytes of data into the arena and return a pointer to the copy.
+
+    Returns NULL on failure.
+*/
+void* arenaCopy(Arena* arena, const void* data, size_t size);
+
+void printArenaStatistics(FILE* stream, const char* name, Arena* arena);
+
+#endif
@@ -0,0 +1,146 @@
+#include "Ast.h"
+#include "StretchyBuffer.h"
+#include <stdlib.h>
+
+const char* NODE_KIND_TO_STRING[] = {
+    #define NODE(n) [NODE_##n] = #n,
+    NODES
+    #undef NODE
+};
+
+Ast* newAst(uint32_t capacity) {
+    Ast* ast = calloc(1, sizeof(Ast));
+    if (!ast) return NULL;
+
+    ast->Capacity = capacity > 16 ? capacity : 16;
+    ast->Kinds = malloc(ast->Capacity * sizeof(uint8_t));
+    ast->Operations = malloc(ast->Capacity * sizeof(uint8_t));
+    ast->First = malloc(ast->Capacity * sizeof(uint32_t));
+    ast->Second = malloc(ast->Capacity * sizeof(uint32_t));
+    ast->Extra = newStretchyBuffer(sizeof(uint32_t));
+    if (!ast->Kinds || !ast->Operations || !ast->First || !ast->Second || !ast->Extra) {
+        freeAst(ast);
+        return NULL;
+    }
+
+    addNode(ast, NODE_UNKNOWN, 0, 0);
+    return ast;
+}
+
+void freeAst(Ast* ast) {
+    if (!ast) return;
+    free(ast->Kinds);
+    free(ast->Operations);
+    free(ast->First);
+    free(ast->Second);
+    freeStretchyBuffer(ast->Extra);
+    free(ast);
+}
+
+static void growAst(Ast* ast) {
+    ast->Capacity += ast->Capacity / 2;
+    ast->Kinds = realloc(ast->Kinds, ast->Capacity * sizeof(uint8_t));
+    ast->Operations = realloc(ast->Operations, ast->Capacity * sizeof(uint8_t));
+    ast->First = realloc(ast->First, ast->Capacity * sizeof(uint32_t));
+    ast->Second = realloc(ast->Second, ast->Capacity * sizeof(uint32_t));
+}
+
+NodeIndex addNode(Ast* ast, NodeKind kind, uint32_t first, uint32_t second) {
+    if (ast->Count == ast->Capacity) {
+        growAst(ast);
+    }
+
+    NodeIndex node = ast->Count++;
+    ast->Kinds[node] = kind;
+    ast->Operations[node] = 0;
+    ast->First[node] = first;
+    ast->Second[node] = second;
+    return node;
+}
+
+uint32_t addExtra(Ast* ast, const uint32_t* values, uint32_t count) {
+    uint32_t start = bufferLength(ast->Extra);
+    for (uint32_t i = 0; i < count; i++) {
+        bufferPush(ast->Extra, values[i]);
+    }
+    return start;
+}
+
+NodeIndex copyNodes(Ast* ast, const Ast* from, NodeIndex first, NodeIndex end, uint32_t firstExtra, uint32_t extraEnd) {
+    while (ast->Capacity - ast->Count < end - first) {
+        growAst(ast);
+    }
+
+    NodeIndex base = ast->Count;
+    uint32_t extraBase = addExtra(ast, from->Extra + firstExtra, extraEnd - firstExtra);
+    #define RELOCATE_NODE(node) ((node) ? (node) - first + base : NODE_NONE)
+    #define RELOCATE_EXTRA(extra) ((extra) - firstExtra + extraBase)
+
+    for (NodeIndex node = first; node < end; node++) {
+        NodeKind kind = from->Kinds[node];
+        uint32_t firstOperand = from->First[node];
+        uint32_t secondOperand = from->Second[node];
+        switch (kind) {
+            case NODE_UNARY:
+            case NODE_EXPRESSION_STATEMENT:
+            case NODE_RETURN: {
+                firstOperand = RELOCATE_NODE(firstOperand);
+            } break;
+            case NODE_BINARY: {
+                firstOperand = RELOCATE_NODE(firstOperand);
+                secondOperand = RELOCATE_NODE(secondOperand);
+            } break;
+            case NODE_VARIABLE_DECLARATION: {
+                secondOperand = RELOCATE_NODE(secondOperand);
+            } break;
+            case NODE_PROGRAM:
+            case NODE_BLOCK: {
+                firstOperand = RELOCATE_EXTRA(firstOperand);
+                uint32_t* statements = ast->Extra + firstOperand;
+                for (uint32_t i = 0; i < secondOperand; i++) {
+                    statements[i] = RELOCATE_NODE(statements[i]);
+                }
+            } break;
+            case NODE_CALL: {
+                secondOperand = RELOCATE_EXTRA(secondOperand);
+                uint32_t* extra = ast->Extra + secondOperand;
+                for (uint32_t i = 1; i <= extra[0]; i++) {
+                    extra[i] = RELOCATE_NODE(extra[i]);
+                }
+            } break;
+            case NODE_IF: {
+                firstOperand = RELOCATE_NODE(firstOperand);
+                secondOperand = RELOCATE_EXTRA(secondOperand);
+                uint32_t* extra = ast->Extra + secondOperand;
+                extra[0] = RELOCATE_NODE(extra[0]);
+                extra[1] = RELOCATE_NODE(extra[1]);
+            } break;
+            case NODE_FUNCTION_DECLARATION: {
+                secondOperand = RELOCATE_EXTRA(secondOperand);
+                uint32_t* extra = ast->Extra + secondOperand;
+                extra[0] = RELOCATE_NODE(extra[0]);
+                for (uint32_t i = 0; i < extra[1]; i++) {
+                    extra[2 + i] = RELOCATE_NODE(extra[2 + i]);
+                }
+            } break;
+            default: break;
+        }
+
+        NodeIndex copy = ast->Count++;
+        ast->Kinds[copy] = kind;
+        ast->Operations[copy] = from->Operations[node];
+        ast->First[copy] = firstOperand;
+        ast->Second[copy] = secondOperand;
+    }
+
+    #undef RELOCATE_NODE
+    #undef RELOCATE_EXTRA
+    return base;
+}
+
+void printAstStatistics(FILE* stream, Ast* ast) {
+    size_t nodeBytes = ast->Capacity * (2 * sizeof(uint8_t) + 2 * sizeof(uint32_t));
+    size_t extraBytes = bufferCapacity(ast->Extra) * sizeof(uint32_t);
+    fprintf(stream, "AST: %u nodes, %zu extra, %zu bytes reserved\n",
+        ast->Count, bufferLength(ast->Extra), nodeBytes + extraBytes);
+}
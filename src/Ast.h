@@ -0,0 +1,101 @@
+#ifndef AST_H
+#define AST_H
+
+#include "Common.h"
+#include "Symbol.h"
+#include <stdio.h>
+
+typedef uint32_t NodeIndex;
+
+// Node 0 of every tree is a placeholder, so 0 doubles as "no node".
+#define NODE_NONE 0
+
+#define NODES \
+        NODE(UNKNOWN) \
+        NODE(PROGRAM) \
+        NODE(INTEGER_LITERAL) \
+        NODE(FLOAT_LITERAL) \
+        NODE(STRING_LITERAL) \
+        NODE(VARIABLE) \
+        NODE(UNARY) \
+        NODE(BINARY) \
+        NODE(CALL) \
+        NODE(EXPRESSION_STATEMENT) \
+        NODE(BLOCK) \
+        NODE(LAZY_BLOCK) \
+        NODE(IF) \
+        NODE(RETURN) \
+        NODE(VARIABLE_DECLARATION) \
+        NODE(FUNCTION_DECLARATION) \
+
+typedef enum NodeKind {
+    #define NODE(n) NODE_##n,
+    NODES
+    #undef NODE
+    NODE_KIND_COUNT
+} NodeKind;
+extern const char* NODE_KIND_TO_STRING[];
+
+/*
+    A syntax tree stored as parallel arrays of nodes addressed by index. Every node has a kind and two 32-bit
+    operands; children lists live in Extra and are referenced by their start index.
+
+    Kind                    First               Second
+    PROGRAM, BLOCK          Extra start         statement count
+    LAZY_BLOCK              first token         token after the block
+    INTEGER_LITERAL,        low 32 bits         high 32 bits
+    FLOAT_LITERAL
+    STRING_LITERAL          Symbol
+    VARIABLE                Symbol
+    UNARY                   operand
+    BINARY                  left                right
+    CALL                    Symbol              Extra: arity, arguments...
+    EXPRESSION_STATEMENT,   expression
+    RETURN
+    IF                      condition           Extra: block, else block
+    VARIABLE_DECLARATION    Symbol              initializer
+    FUNCTION_DECLARATION    Symbol              Extra: block, arity, parameters...
+
+    Operations holds the Operation of UNARY and BINARY nodes. Children are always added before their parent.
+*/
+typedef struct Ast {
+    uint8_t* Kinds;
+    uint8_t* Operations;
+    uint32_t* First;
+    uint32_t* Second;
+    uint32_t Count;
+    uint32_t Capacity;
+    uint32_t* Extra;
+    NodeIndex Root;
+} Ast;
+
+/*
+    Create an empty tree with room for `capacity` nodes.
+
+    Returns NULL on failure.
+*/
+Ast* newAst(uint32_t capacity);
+void freeAst(Ast* ast);
+
+NodeIndex addNode(Ast* ast, NodeKind kind, uint32_t first, uint32_t second);
+
+/*
+    Append `count` values to the extra data and return the index of the first one.
+*/
+uint32_t addExtra(Ast* ast, const uint32_t* values, uint32_t count);
+
+/*
+    Copy nodes [first, end) of another tree, together with their extra data [firstExtra, extraEnd), to the end of
+    `ast`. The nodes may only refer to each other, as the nodes of one subtree do. Node `n` of the range becomes
+    node `n - first` plus the returned index.
+*/
+NodeIndex copyNodes(Ast* ast, const Ast* from, NodeIndex first, NodeIndex end, uint32_t firstExtra, uint32_t extraEnd);
+
+void printAstStatistics(FILE* stream, Ast* ast);
+
+#define nodeKind(ast, node) ((NodeKind)(ast)->Kinds[node])
+#define nodeFirst(ast, node) ((ast)->First[node])
+#define nodeSecond(ast, node) ((ast)->Second[node])
+#define nodeExtra(ast, node) ((ast)->Extra + (ast)->Second[node])
+
+#endif
@@ -0,0 +1,271 @@
+#define _DEFAULT_SOURCE
+#include "Cache.h"
+#include "SourceBuffer.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define NASHC_VERSION "0.1.0"
+
+// A rebuilt compiler may generate different code, so it never reuses the artifacts of another build.
+static const char COMPILER_IDENTITY[] = NASHC_VERSION " " __DATE__ " " __TIME__;
+
+// Name of the file holding the hit and miss counters, which can't collide with the hex names of entries.
+static const char STATISTICS_NAME[] = "statistics";
+
+// Two independent lanes of a multiply-mix hash, 16 bytes per step per lane.
+static const uint64_t HASH_SECRETS[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+};
+
+static uint64_t mix(uint64_t a, uint64_t b) {
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static uint64_t read64(const char* bytes) {
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static void hashBytes(uint64_t hash[2], const char* bytes, size_t length) {
+    const char* p = bytes;
+    const char* end = bytes + length;
+    for (; end - p >= 16; p += 16) {
+        uint64_t low = read64(p);
+        uint64_t high = read64(p + 8);
+        hash[0] = mix(low ^ HASH_SECRETS[0], high ^ hash[0]);
+        hash[1] = mix(high ^ HASH_SECRETS[1], low ^ hash[1]);
+    }
+
+    char tail[16] = { 0 };
+    memcpy(tail, p, end - p);
+    hash[0] = mix(read64(tail) ^ HASH_SECRETS[2], read64(tail + 8) ^ hash[0] ^ length);
+    hash[1] = mix(read64(tail + 8) ^ HASH_SECRETS[3], read64(tail) ^ hash[1] ^ length);
+}
+
+CacheKey cacheKey(const char* source, size_t length, const char* options) {
+    CacheKey key = { .Hash = { HASH_SECRETS[0], HASH_SECRETS[3] } };
+    hashBytes(key.Hash, COMPILER_IDENTITY, sizeof(COMPILER_IDENTITY));
+    hashBytes(key.Hash, options, strlen(options) + 1);
+    hashBytes(key.Hash, source, length);
+    return key;
+}
+
+static bool createDirectories(char* path) {
+    for (char* slash = strchr(path + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        bool created = mkdir(path, 0755) == 0 || errno == EEXIST;
+        *slash = '/';
+        if (!created) return false;
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+Cache* openCache(const char* directory, uint64_t limit) {
+    Cache* cache = calloc(1, sizeof(Cache));
+    if (!cache) return NULL;
+
+    cache->Directory = strdup(directory);
+    cache->Limit = limit;
+    if (!cache->Directory || !createDirectories(cache->Directory)) {
+        freeCache(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void freeCache(Cache* cache) {
+    if (!cache) return;
+    free(cache->Directory);
+    free(cache);
+}
+
+/*
+    Path of a file in the cache directory. The caller frees it.
+*/
+static char* cachePath(Cache* cache, const char* name) {
+    size_t length = strlen(cache->Directory) + strlen(name) + 2;
+    char* path = malloc(length);
+    snprintf(path, length, "%s/%s", cache->Directory, name);
+    return path;
+}
+
+static char* entryPath(Cache* cache, CacheKey key) {
+    char name[33];
+    snprintf(name, sizeof(name), "%016llx%016llx", (unsigned long long)key.Hash[0], (unsigned long long)key.Hash[1]);
+    return cachePath(cache, name);
+}
+
+static bool writeFile(const char* path, const char* data, size_t length, mode_t mode) {
+    int file = open(path, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (file < 0) return false;
+
+    while (length > 0) {
+        ssize_t written = write(file, data, length);
+        if (written <= 0) {
+            close(file);
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+    return close(file) == 0;
+}
+
+/*
+    Add to the persistent hit and miss counters. The file is locked, since several builds may share the cache.
+*/
+static void countLookup(Cache* cache, uint64_t hits, uint64_t misses, CacheStatistics* statistics) {
+    char* path = cachePath(cache, STATISTICS_NAME);
+    int file = open(path, O_RDWR | O_CREAT, 0644);
+    free(path);
+    if (file < 0) return;
+
+    flock(file, LOCK_EX);
+    char counters[64] = { 0 };
+    unsigned long long storedHits = 0;
+    unsigned long long storedMisses = 0;
+    if (pread(file, counters, sizeof(counters) - 1, 0) > 0) {
+        sscanf(counters, "%llu %llu", &storedHits, &storedMisses);
+    }
+    storedHits += hits;
+    storedMisses += misses;
+    if (hits || misses) {
+        int length = snprintf(counters, sizeof(counters), "%llu %llu\n", storedHits, storedMisses);
+        if (pwrite(file, counters, length, 0) == length) {
+            ftruncate(file, length);
+        }
+    }
+    flock(file, LOCK_UN);
+    close(file);
+
+    if (statistics) {
+        statistics->Hits = storedHits;
+        statistics->Misses = storedMisses;
+    }
+}
+
+bool fetchCached(Cache* cache, CacheKey key, const char* path, bool executable) {
+    char* entry = entryPath(cache, key);
+    SourceBuffer* artifact = openSourceBuffer(entry);
+    bool fetched = artifact && writeFile(path, artifact->Data, artifact->Length, executable ? 0755 : 0644);
+    if (fetched) {
+        // Bump the entry to most recently used.
+        utimensat(AT_FDCWD, entry, NULL, 0);
+    }
+    freeSourceBuffer(artifact);
+    free(entry);
+
+    countLookup(cache, fetched, !fetched, NULL);
+    return fetched;
+}
+
+typedef struct CacheEntry {
+    char* Name;
+    uint64_t Size;
+    struct timespec LastUse;
+} CacheEntry;
+
+static int compareLastUse(const void* a, const void* b) {
+    const struct timespec* x = &((const CacheEntry*)a)->LastUse;
+    const struct timespec* y = &((const CacheEntry*)b)->LastUse;
+    if (x->tv_sec != y->tv_sec) return x->tv_sec < y->tv_sec ? -1 : 1;
+    if (x->tv_nsec != y->tv_nsec) return x->tv_nsec < y->tv_nsec ? -1 : 1;
+    return 0;
+}
+
+/*
+    List the stored artifacts. Entries are named by their 32 hex digit key; anything else is skipped.
+*/
+static CacheEntry* listEntries(Cache* cache, size_t* count, uint64_t* bytes) {
+    *count = 0;
+    *bytes = 0;
+    DIR* directory = opendir(cache->Directory);
+    if (!directory) return NULL;
+
+    size_t capacity = 64;
+    CacheEntry* entries = malloc(capacity * sizeof(CacheEntry));
+    struct dirent* item;
+    while ((item = readdir(directory))) {
+        if (strlen(item->d_name) != 32 || strspn(item->d_name, "0123456789abcdef") != 32) continue;
+
+        struct stat status;
+        if (fstatat(dirfd(directory), item->d_name, &status, 0) != 0 || !S_ISREG(status.st_mode)) continue;
+        if (*count == capacity) {
+            capacity += capacity / 2;
+            entries = realloc(entries, capacity * sizeof(CacheEntry));
+        }
+        entries[(*count)++] = (CacheEntry) { .Name = strdup(item->d_name), .Size = status.st_size, .LastUse = status.st_mtim };
+        *bytes += status.st_size;
+    }
+    closedir(directory);
+    return entries;
+}
+
+void trimCache(Cache* cache) {
+    size_t count;
+    uint64_t bytes;
+    CacheEntry* entries = listEntries(cache, &count, &bytes);
+    if (!entries) return;
+
+    if (bytes > cache->Limit) {
+        qsort(entries, count, sizeof(CacheEntry), compareLastUse);
+        for (size_t i = 0; i < count && bytes > cache->Limit; i++) {
+            char* path = cachePath(cache, entries[i].Name);
+            if (unlink(path) == 0) {
+                bytes -= entries[i].Size;
+            }
+            free(path);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        free(entries[i].Name);
+    }
+    free(entries);
+}
+
+bool storeCached(Cache* cache, CacheKey key, const char* path) {
+    SourceBuffer* artifact = openSourceBuffer(path);
+    if (!artifact) return false;
+
+    // Written under a name of its own and renamed into place, so concurrent builds never see half an entry.
+    char* entry = entryPath(cache, key);
+    size_t temporaryLength = strlen(entry) + 32;
+    char* temporary = malloc(temporaryLength);
+    snprintf(temporary, temporaryLength, "%s.%ld.tmp", entry, (long)getpid());
+    bool stored = writeFile(temporary, artifact->Data, artifact->Length, 0644) && rename(temporary, entry) == 0;
+    if (!stored) {
+        unlink(temporary);
+    }
+    free(temporary);
+    free(entry);
+    freeSourceBuffer(artifact);
+
+    if (stored) {
+        trimCache(cache);
+    }
+    return stored;
+}
+
+CacheStatistics cacheStatistics(Cache* cache) {
+    CacheStatistics statistics = { 0 };
+    countLookup(cache, 0, 0, &statistics);
+
+    size_t count;
+    CacheEntry* entries = listEntries(cache, &count, &statistics.Bytes);
+    statistics.Entries = count;
+    for (size_t i = 0; i < count; i++) {
+        free(entries[i].Name);
+    }
+    free(entries);
+    return statistics;
+}
@@ -0,0 +1,66 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "Common.h"
+
+// Size the cache is trimmed to when no limit is given.
+#define CACHE_DEFAULT_LIMIT (256ull * 1024 * 1024)
+
+/*
+    Identifies one build artifact: a 128-bit hash of the source, the compiler and the options that change the output.
+*/
+typedef struct CacheKey {
+    uint64_t Hash[2];
+} CacheKey;
+
+/*
+    A directory of previously built artifacts, each stored under its key. When it grows past `Limit` bytes, the
+    entries used least recently are deleted first; an entry's modification time is its last use.
+*/
+typedef struct Cache {
+    char* Directory;
+    uint64_t Limit;
+} Cache;
+
+typedef struct CacheStatistics {
+    uint64_t Hits;
+    uint64_t Misses;
+    uint64_t Entries;
+    uint64_t Bytes;
+} CacheStatistics;
+
+/*
+    Open a cache directory, creating it and its parents when they don't exist.
+
+    Returns NULL on failure.
+*/
+Cache* openCache(const char* directory, uint64_t limit);
+void freeCache(Cache* cache);
+
+/*
+    Key the artifact built from `source` by this compiler with the given output options.
+*/
+CacheKey cacheKey(const char* source, size_t length, const char* options);
+
+/*
+    Copy the artifact stored under `key` to `path`, and count a hit or a miss.
+
+    Returns false on a miss or failure.
+*/
+bool fetchCached(Cache* cache, CacheKey key, const char* path, bool executable);
+
+/*
+    Store a copy of the artifact at `path` under `key`, then evict entries until the cache fits its limit.
+
+    Returns false on failure.
+*/
+bool storeCached(Cache* cache, CacheKey key, const char* path);
+
+/*
+    Evict the entries used least recently until the cache fits its limit.
+*/
+void trimCache(Cache* cache);
+
+CacheStatistics cacheStatistics(Cache* cache);
+
+#endif
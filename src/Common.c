@@ -1,5 +1,7 @@
+#define _POSIX_C_SOURCE 199309L
 #include "Common.h"
 #include <string.h>
+#include <time.h>
 
 
 bool streq(const char* a, const char* b) {
@@ -9,4 +11,10 @@ bool streq(const char* a, const char* b) {
 }
 bool strneq(const char* a, const char* b, size_t length) {
     return strncmp(a, b, length) == 0;
+}
+
+uint64_t currentNanoseconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
 }
\ No newline at end of file
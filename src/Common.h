@@ -10,4 +10,9 @@
 bool streq(const char* a, const char* b);
 bool strneq(const char* a, const char* b, size_t length);
 
+/*
+    Monotonic clock reading in nanoseconds, for timing compiler phases.
+*/
+uint64_t currentNanoseconds(void);
+
 #endif
\ No newline at end of file
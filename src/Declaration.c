@@ -1,27 +1,15 @@
 #include "Declaration.h"
 #include "Common.h"
 #include "Expression.h"
-#include "Statement.h"
-#include <stdlib.h>
+#include "Ast.h"
 
-static Declaration* newDeclaration(const char* name, DeclarationType type) {
-    Declaration* declaration = calloc(1, sizeof(Declaration));
-    declaration->Name = name;
-    declaration->Type = type;
-    return declaration;
+NodeIndex newVariableDeclaration(Ast* ast, Symbol name, NodeIndex initializer) {
+    return addNode(ast, NODE_VARIABLE_DECLARATION, name, initializer);
 }
 
-Declaration* newVariableDeclaration(const char* name, Expression* initializer) {
-    Declaration* variableDeclaration = newDeclaration(name, DECLARATION_VARIABLE);
-    variableDeclaration->Variable.Initializer = initializer;
-    return variableDeclaration;
-}
-
-Declaration* newFunctionDeclaration(const char* name, Declaration** parameters, size_t arity, const char* returnType, Statement* block) {
-    Declaration* functionDeclaration = newDeclaration(name, DECLARATION_FUNCTION);
-    functionDeclaration->Function.Parameters = parameters;
-    functionDeclaration->Function.Arity = arity;
-    functionDeclaration->Function.ReturnType = returnType;
-    functionDeclaration->Function.Block = block;
-    return functionDeclaration;
+NodeIndex newFunctionDeclaration(Ast* ast, Symbol name, const NodeIndex* parameters, uint32_t arity, NodeIndex block) {
+    uint32_t header[] = { block, arity };
+    uint32_t extra = addExtra(ast, header, 2);
+    addExtra(ast, parameters, arity);
+    return addNode(ast, NODE_FUNCTION_DECLARATION, name, extra);
 }
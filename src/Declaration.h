@@ -4,36 +4,12 @@
 #include "Common.h"
 #include "Expression.h"
 
-typedef struct Declaration Declaration;
-typedef struct Statement Statement;
-typedef enum DeclarationType {
-    DECLARATION_UNKNOWN,
-    DECLARATION_VARIABLE,
-    DECLARATION_FUNCTION
-} DeclarationType;
+NodeIndex newVariableDeclaration(Ast* ast, Symbol name, NodeIndex initializer);
+// TODO: add proper type system
+NodeIndex newFunctionDeclaration(Ast* ast, Symbol name, const NodeIndex* parameters, uint32_t arity, NodeIndex block);
 
-typedef struct VariableDeclaration {
-    Expression* Initializer;
-} VariableDeclaration;
-
-typedef struct FunctionDeclaration {
-    Declaration** Parameters;
-    size_t Arity;
-    // TODO: add proper type system
-    const char* ReturnType;
-    Statement* Block;
-} FunctionDeclaration;
-
-struct Declaration {
-    const char* Name;
-    DeclarationType Type;
-    union {
-        VariableDeclaration Variable;
-        FunctionDeclaration Function;
-    };
-};
-
-Declaration* newVariableDeclaration(const char* name, Expression* initializer);
-Declaration* newFunctionDeclaration(const char* name, Declaration** parameters, size_t arity, const char* returnType, Statement* block);
+#define functionBlock(ast, node) (nodeExtra(ast, node)[0])
+#define functionArity(ast, node) (nodeExtra(ast, node)[1])
+#define functionParameters(ast, node) (nodeExtra(ast, node) + 2)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#define _GNU_SOURCE
+#include "Driver.h"
+#include "SourceBuffer.h"
+#include "StretchyBuffer.h"
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+pid_t spawnProcess(char* const* arguments) {
+    pid_t process;
+    if (posix_spawn(&process, arguments[0], NULL, NULL, arguments, environ) != 0) return -1;
+    return process;
+}
+
+pid_t spawnPipedProcess(char* const* arguments, int* input) {
+    // Both ends are close-on-exec, so the child only keeps the copy of the read end that becomes its stdin and
+    // sees the end of the input as soon as the caller closes the write end.
+    int pipeEnds[2];
+    if (pipe2(pipeEnds, O_CLOEXEC) != 0) return -1;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipeEnds[0], STDIN_FILENO);
+    pid_t process;
+    bool spawned = posix_spawn(&process, arguments[0], &actions, NULL, arguments, environ) == 0;
+    posix_spawn_file_actions_destroy(&actions);
+
+    close(pipeEnds[0]);
+    if (!spawned) {
+        close(pipeEnds[1]);
+        return -1;
+    }
+    *input = pipeEnds[1];
+    return process;
+}
+
+int waitProcess(pid_t process) {
+    int status;
+    if (waitpid(process, &status, 0) < 0 || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
+
+uint32_t runProcesses(char** const* commands, size_t count, uint32_t jobs) {
+    uint32_t failures = 0;
+    uint32_t running = 0;
+    size_t next = 0;
+    while (running > 0 || (next < count && failures == 0)) {
+        while (running < jobs && next < count && failures == 0) {
+            if (spawnProcess(commands[next++]) < 0) {
+                failures++;
+            } else {
+                running++;
+            }
+        }
+        if (running == 0) break;
+
+        // Whichever process finishes first makes room for the next command.
+        int status;
+        if (waitpid(-1, &status, 0) < 0) {
+            failures += running;
+            break;
+        }
+        running--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failures++;
+        }
+    }
+    return failures;
+}
+
+bool readManifest(const char* path, char*** paths) {
+    SourceBuffer* manifest = openSourceBuffer(path);
+    if (!manifest) return false;
+
+    const char* end = manifest->Data + manifest->Length;
+    for (const char* line = manifest->Data; line < end;) {
+        const char* lineEnd = memchr(line, '\n', end - line);
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+
+        const char* first = line;
+        const char* last = lineEnd;
+        while (first < last && (*first == ' ' || *first == '\t')) first++;
+        while (last > first && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) last--;
+        if (first < last && *first != '#') {
+            bufferPush((*paths), strndup(first, last - first));
+        }
+        line = lineEnd + 1;
+    }
+
+    freeSourceBuffer(manifest);
+    return true;
+}
+
+char* objectPathFor(const char* sourcePath) {
+    size_t length = strlen(sourcePath);
+    if (length > 5 && streq(sourcePath + length - 5, ".nash")) {
+        length -= 5;
+    }
+
+    char* path = malloc(length + 3);
+    memcpy(path, sourcePath, length);
+    memcpy(path + length, ".o", 3);
+    return path;
+}
+
+char* makeTemporaryDirectory(void) {
+    const char* parent = getenv("TMPDIR");
+    if (!parent || !*parent) {
+        parent = "/tmp";
+    }
+    size_t length = strlen(parent);
+    char* path = malloc(length + sizeof("/nash-XXXXXX"));
+    memcpy(path, parent, length);
+    memcpy(path + length, "/nash-XXXXXX", sizeof("/nash-XXXXXX"));
+    if (!mkdtemp(path)) {
+        free(path);
+        return NULL;
+    }
+    return path;
+}
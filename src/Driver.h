@@ -0,0 +1,59 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "Common.h"
+#include <sys/types.h>
+
+/*
+    Start `arguments[0]` as a child process with the given NULL-terminated arguments, without replacing this one.
+
+    Returns -1 on failure.
+*/
+pid_t spawnProcess(char* const* arguments);
+
+/*
+    Start a child process like spawnProcess, with its standard input connected to a pipe. `input` is set to the
+    pipe's write end, which the caller closes to signal the end of the input.
+
+    Returns -1 on failure.
+*/
+pid_t spawnPipedProcess(char* const* arguments, int* input);
+
+/*
+    Wait for a child process to finish.
+
+    Returns its exit status, or -1 when it didn't exit normally.
+*/
+int waitProcess(pid_t process);
+
+/*
+    Run every command as its own process, at most `jobs` of them at a time. Each finished process immediately frees
+    its slot for the next command. Once a command fails, no new ones are started, but those running are waited for.
+
+    Returns the number of commands that failed or couldn't be started.
+*/
+uint32_t runProcesses(char** const* commands, size_t count, uint32_t jobs);
+
+/*
+    Read the input files listed in a manifest, one path per line. Blank lines and lines starting with '#' are
+    skipped. The paths are appended to `paths`, a stretchy buffer, and stay valid until freed with the buffer's
+    contents.
+
+    Returns false when the manifest can't be read.
+*/
+bool readManifest(const char* path, char*** paths);
+
+/*
+    Path of the object built from a source file: its `.nash` extension replaced with `.o`. The caller frees it.
+*/
+char* objectPathFor(const char* sourcePath);
+
+/*
+    Create a directory only this process uses, under $TMPDIR or /tmp, for files that are deleted once a build is
+    done. The caller frees the path.
+
+    Returns NULL on failure.
+*/
+char* makeTemporaryDirectory(void);
+
+#endif
@@ -0,0 +1,369 @@
+#define _DEFAULT_SOURCE
+#include "Elf.h"
+#include "Symbol.h"
+#include "SourceBuffer.h"
+#include "StretchyBuffer.h"
+#include <elf.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Where the executable's only segment is mapped, the usual base address of x86-64 executables.
+#define EXECUTABLE_BASE 0x400000
+#define EXECUTABLE_ALIGNMENT 0x1000
+// The code follows the file header and its one program header.
+#define CODE_OFFSET (sizeof(Elf64_Ehdr) + sizeof(Elf64_Phdr))
+
+bool resolveSymbols(Emitter* emitter, const char** undefined) {
+    // Symbol names are interned so the table can be indexed by them directly.
+    size_t symbolDefinitions = bufferLength(emitter->Symbols);
+    Symbol* names = malloc((symbolDefinitions + 1) * sizeof(Symbol));
+    for (size_t i = 0; i < symbolDefinitions; i++) {
+        const char* name = emitter->Symbols[i].Name;
+        names[i] = intern(name, strlen(name));
+    }
+
+    uint32_t* offsets = malloc(symbolCount() * sizeof(uint32_t));
+    memset(offsets, 0xFF, symbolCount() * sizeof(uint32_t));
+    for (size_t i = symbolDefinitions; i-- > 0;) {
+        offsets[names[i]] = emitter->Symbols[i].Offset;
+    }
+
+    bool resolved = true;
+    for (size_t i = 0; i < bufferLength(emitter->SymbolFixups); i++) {
+        Fixup fixup = emitter->SymbolFixups[i];
+        Symbol name = intern(fixup.Name, strlen(fixup.Name));
+        uint32_t target = name < symbolCount() ? offsets[name] : LABEL_UNDEFINED;
+        if (name >= symbolCount() || target == LABEL_UNDEFINED) {
+            *undefined = fixup.Name;
+            resolved = false;
+            break;
+        }
+
+        uint32_t displacement = target - (fixup.Offset + 4);
+        uint8_t bytes[4] = { displacement, displacement >> 8, displacement >> 16, displacement >> 24 };
+        memcpy(emitter->Data + fixup.Offset, bytes, 4);
+    }
+
+    free(offsets);
+    free(names);
+    return resolved;
+}
+
+bool writeExecutable(Emitter* emitter, const char* entry, const char* path) {
+    const SymbolDefinition* start = NULL;
+    for (size_t i = 0; i < bufferLength(emitter->Symbols) && !start; i++) {
+        if (streq(emitter->Symbols[i].Name, entry)) {
+            start = &emitter->Symbols[i];
+        }
+    }
+    if (!start) return false;
+
+    Elf64_Ehdr header = {
+        .e_ident = {
+            ELFMAG0, ELFMAG1, ELFMAG2, ELFMAG3, ELFCLASS64, ELFDATA2LSB, EV_CURRENT, ELFOSABI_SYSV,
+        },
+        .e_type = ET_EXEC,
+        .e_machine = EM_X86_64,
+        .e_version = EV_CURRENT,
+        .e_entry = EXECUTABLE_BASE + CODE_OFFSET + start->Offset,
+        .e_phoff = sizeof(Elf64_Ehdr),
+        .e_ehsize = sizeof(Elf64_Ehdr),
+        .e_phentsize = sizeof(Elf64_Phdr),
+        .e_phnum = 1,
+    };
+    // The segment starts at the beginning of the file, so the headers are mapped too but offsets stay simple.
+    Elf64_Phdr segment = {
+        .p_type = PT_LOAD,
+        .p_flags = PF_R | PF_X,
+        .p_offset = 0,
+        .p_vaddr = EXECUTABLE_BASE,
+        .p_paddr = EXECUTABLE_BASE,
+        .p_filesz = CODE_OFFSET + emitter->Length,
+        .p_memsz = CODE_OFFSET + emitter->Length,
+        .p_align = EXECUTABLE_ALIGNMENT,
+    };
+
+    int file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+    if (file < 0) return false;
+
+    struct iovec parts[] = {
+        { &header, sizeof(header) },
+        { &segment, sizeof(segment) },
+        { emitter->Data, emitter->Length },
+    };
+    size_t total = sizeof(header) + sizeof(segment) + emitter->Length;
+    ssize_t written = writev(file, parts, sizeof(parts) / sizeof(parts[0]));
+    bool succeeded = written >= 0 && (size_t)written == total;
+    return close(file) == 0 && succeeded;
+}
+
+// Sections of a written object, in order.
+enum {
+    OBJECT_SECTION_NULL,
+    OBJECT_SECTION_TEXT,
+    OBJECT_SECTION_SYMBOLS,
+    OBJECT_SECTION_STRINGS,
+    OBJECT_SECTION_RELOCATIONS,
+    OBJECT_SECTION_NAMES,
+    // Empty; marks the object as not needing an executable stack.
+    OBJECT_SECTION_STACK_NOTE,
+    OBJECT_SECTION_COUNT,
+};
+
+static const char OBJECT_SECTION_NAMES_TABLE[] = "\0.text\0.symtab\0.strtab\0.rela.text\0.shstrtab\0.note.GNU-stack";
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static uint32_t addString(char** strings, const char* string) {
+    uint32_t offset = bufferLength(*strings);
+    for (const char* c = string; *c; c++) {
+        bufferPush((*strings), *c);
+    }
+    bufferPush((*strings), '\0');
+    return offset;
+}
+
+bool writeObject(Emitter* emitter, const char* path) {
+    size_t definitions = bufferLength(emitter->Symbols);
+    size_t fixups = bufferLength(emitter->SymbolFixups);
+    Symbol* definitionNames = malloc((definitions + 1) * sizeof(Symbol));
+    Symbol* fixupNames = malloc((fixups + 1) * sizeof(Symbol));
+    for (size_t i = 0; i < definitions; i++) {
+        definitionNames[i] = intern(emitter->Symbols[i].Name, strlen(emitter->Symbols[i].Name));
+    }
+    for (size_t i = 0; i < fixups; i++) {
+        fixupNames[i] = intern(emitter->SymbolFixups[i].Name, strlen(emitter->SymbolFixups[i].Name));
+    }
+
+    // Index of each name in the symbol table, 0 until it has an entry.
+    uint32_t* indices = calloc(symbolCount(), sizeof(uint32_t));
+    Elf64_Sym* symbols = newStretchyBuffer(sizeof(Elf64_Sym));
+    Elf64_Rela* relocations = newStretchyBuffer(sizeof(Elf64_Rela));
+    char* strings = newStretchyBuffer(sizeof(char));
+    bufferPush(symbols, ((Elf64_Sym) { 0 }));
+    bufferPush(strings, '\0');
+
+    // Every symbol is global, so they all follow the null symbol. A name defined more than once keeps its first
+    // definition, like resolveSymbols.
+    for (size_t i = 0; i < definitions; i++) {
+        if (indices[definitionNames[i]]) continue;
+        indices[definitionNames[i]] = bufferLength(symbols);
+        Elf64_Sym symbol = {
+            .st_name = addString(&strings, emitter->Symbols[i].Name),
+            .st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC),
+            .st_shndx = OBJECT_SECTION_TEXT,
+            .st_value = emitter->Symbols[i].Offset,
+        };
+        bufferPush(symbols, symbol);
+    }
+    for (size_t i = 0; i < fixups; i++) {
+        if (!indices[fixupNames[i]]) {
+            indices[fixupNames[i]] = bufferLength(symbols);
+            Elf64_Sym symbol = {
+                .st_name = addString(&strings, emitter->SymbolFixups[i].Name),
+                .st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE),
+                .st_shndx = SHN_UNDEF,
+            };
+            bufferPush(symbols, symbol);
+        }
+
+        // The rel32 is the last field of the call, so it is relative to the address 4 bytes past it.
+        Elf64_Rela relocation = {
+            .r_offset = emitter->SymbolFixups[i].Offset,
+            .r_info = ELF64_R_INFO(indices[fixupNames[i]], R_X86_64_PLT32),
+            .r_addend = -4,
+        };
+        bufferPush(relocations, relocation);
+    }
+
+    size_t textOffset = sizeof(Elf64_Ehdr);
+    size_t symbolsOffset = alignUp(textOffset + emitter->Length, 8);
+    size_t symbolsSize = bufferLength(symbols) * sizeof(Elf64_Sym);
+    size_t stringsOffset = symbolsOffset + symbolsSize;
+    size_t relocationsOffset = alignUp(stringsOffset + bufferLength(strings), 8);
+    size_t relocationsSize = bufferLength(relocations) * sizeof(Elf64_Rela);
+    size_t namesOffset = relocationsOffset + relocationsSize;
+    size_t sectionsOffset = alignUp(namesOffset + sizeof(OBJECT_SECTION_NAMES_TABLE), 8);
+
+    Elf64_Ehdr header = {
+        .e_ident = {
+            ELFMAG0, ELFMAG1, ELFMAG2, ELFMAG3, ELFCLASS64, ELFDATA2LSB, EV_CURRENT, ELFOSABI_SYSV,
+        },
+        .e_type = ET_REL,
+        .e_machine = EM_X86_64,
+        .e_version = EV_CURRENT,
+        .e_shoff = sectionsOffset,
+        .e_ehsize = sizeof(Elf64_Ehdr),
+        .e_shentsize = sizeof(Elf64_Shdr),
+        .e_shnum = OBJECT_SECTION_COUNT,
+        .e_shstrndx = OBJECT_SECTION_NAMES,
+    };
+    Elf64_Shdr sections[OBJECT_SECTION_COUNT] = {
+        [OBJECT_SECTION_TEXT] = {
+            .sh_name = 1, .sh_type = SHT_PROGBITS, .sh_flags = SHF_ALLOC | SHF_EXECINSTR,
+            .sh_offset = textOffset, .sh_size = emitter->Length, .sh_addralign = 16,
+        },
+        [OBJECT_SECTION_SYMBOLS] = {
+            .sh_name = 7, .sh_type = SHT_SYMTAB, .sh_offset = symbolsOffset, .sh_size = symbolsSize,
+            .sh_link = OBJECT_SECTION_STRINGS, .sh_info = 1, .sh_addralign = 8, .sh_entsize = sizeof(Elf64_Sym),
+        },
+        [OBJECT_SECTION_STRINGS] = {
+            .sh_name = 15, .sh_type = SHT_STRTAB, .sh_offset = stringsOffset, .sh_size = bufferLength(strings),
+            .sh_addralign = 1,
+        },
+        [OBJECT_SECTION_RELOCATIONS] = {
+            .sh_name = 23, .sh_type = SHT_RELA, .sh_flags = SHF_INFO_LINK, .sh_offset = relocationsOffset,
+            .sh_size = relocationsSize, .sh_link = OBJECT_SECTION_SYMBOLS, .sh_info = OBJECT_SECTION_TEXT,
+            .sh_addralign = 8, .sh_entsize = sizeof(Elf64_Rela),
+        },
+        [OBJECT_SECTION_NAMES] = {
+            .sh_name = 34, .sh_type = SHT_STRTAB, .sh_offset = namesOffset,
+            .sh_size = sizeof(OBJECT_SECTION_NAMES_TABLE), .sh_addralign = 1,
+        },
+        [OBJECT_SECTION_STACK_NOTE] = {
+            .sh_name = 44, .sh_type = SHT_PROGBITS, .sh_offset = namesOffset, .sh_addralign = 1,
+        },
+    };
+
+    static const char padding[8] = { 0 };
+    struct iovec parts[] = {
+        { &header, sizeof(header) },
+        { emitter->Data, emitter->Length },
+        { (void*)padding, symbolsOffset - (textOffset + emitter->Length) },
+        { symbols, symbolsSize },
+        { strings, bufferLength(strings) },
+        { (void*)padding, relocationsOffset - (stringsOffset + bufferLength(strings)) },
+        { relocations, relocationsSize },
+        { (void*)OBJECT_SECTION_NAMES_TABLE, sizeof(OBJECT_SECTION_NAMES_TABLE) },
+        { (void*)padding, sectionsOffset - (namesOffset + sizeof(OBJECT_SECTION_NAMES_TABLE)) },
+        { sections, sizeof(sections) },
+    };
+
+    bool succeeded = false;
+    int file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file >= 0) {
+        ssize_t written = writev(file, parts, sizeof(parts) / sizeof(parts[0]));
+        succeeded = written >= 0 && (size_t)written == sectionsOffset + sizeof(sections);
+        succeeded = close(file) == 0 && succeeded;
+    }
+
+    freeStretchyBuffer(symbols);
+    freeStretchyBuffer(relocations);
+    freeStretchyBuffer(strings);
+    free(indices);
+    free(fixupNames);
+    free(definitionNames);
+    return succeeded;
+}
+
+/*
+    Check that a section table entry lies within the file.
+*/
+static bool sectionInFile(const SourceBuffer* file, const Elf64_Shdr* section) {
+    return section->sh_type == SHT_NOBITS
+        || (section->sh_offset <= file->Length && section->sh_size <= file->Length - section->sh_offset);
+}
+
+Emitter* readObject(const char* path) {
+    SourceBuffer* file = openSourceBuffer(path);
+    if (!file) return NULL;
+
+    const Elf64_Ehdr* header = (const Elf64_Ehdr*)file->Data;
+    if (file->Length < sizeof(Elf64_Ehdr) || memcmp(header->e_ident, ELFMAG, SELFMAG) != 0
+        || header->e_ident[EI_CLASS] != ELFCLASS64 || header->e_type != ET_REL || header->e_machine != EM_X86_64
+        || header->e_shentsize != sizeof(Elf64_Shdr) || header->e_shoff > file->Length
+        || header->e_shnum > (file->Length - header->e_shoff) / sizeof(Elf64_Shdr)) {
+        freeSourceBuffer(file);
+        return NULL;
+    }
+
+    // Sections are copied out with memcpy, since the file's data is only guaranteed to be byte-aligned.
+    uint32_t sectionCount = header->e_shnum;
+    Elf64_Shdr* sections = malloc((sectionCount + 1) * sizeof(Elf64_Shdr));
+    memcpy(sections, file->Data + header->e_shoff, sectionCount * sizeof(Elf64_Shdr));
+    uint32_t* bases = malloc((sectionCount + 1) * sizeof(uint32_t));
+    Emitter* emitter = newEmitter(EMITTER_MACHINE_CODE, file->Length);
+    bool valid = true;
+
+    // Code sections are laid out one after another, in section order.
+    for (uint32_t i = 0; i < sectionCount && valid; i++) {
+        bases[i] = LABEL_UNDEFINED;
+        valid = sectionInFile(file, &sections[i]);
+        if (valid && sections[i].sh_type == SHT_PROGBITS && (sections[i].sh_flags & SHF_EXECINSTR)) {
+            bases[i] = emitter->Length;
+            emitBytes(emitter, file->Data + sections[i].sh_offset, sections[i].sh_size);
+        }
+    }
+
+    for (uint32_t i = 0; i < sectionCount && valid; i++) {
+        if (sections[i].sh_type != SHT_SYMTAB) continue;
+        const Elf64_Shdr* strings = sections[i].sh_link < sectionCount ? &sections[sections[i].sh_link] : NULL;
+        valid = strings && strings->sh_type == SHT_STRTAB && sections[i].sh_entsize == sizeof(Elf64_Sym);
+        const char* names = valid ? file->Data + strings->sh_offset : NULL;
+
+        size_t symbolEntries = valid ? sections[i].sh_size / sizeof(Elf64_Sym) : 0;
+        for (size_t j = 0; j < symbolEntries; j++) {
+            Elf64_Sym symbol;
+            memcpy(&symbol, file->Data + sections[i].sh_offset + j * sizeof(Elf64_Sym), sizeof(symbol));
+            if (ELF64_ST_BIND(symbol.st_info) != STB_GLOBAL || symbol.st_shndx >= sectionCount) continue;
+            if (bases[symbol.st_shndx] == LABEL_UNDEFINED || symbol.st_name >= strings->sh_size) continue;
+
+            const char* name = names + symbol.st_name;
+            SymbolDefinition definition = {
+                .Name = symbolName(intern(name, strnlen(name, strings->sh_size - symbol.st_name))),
+                .Offset = bases[symbol.st_shndx] + symbol.st_value,
+            };
+            bufferPush(emitter->Symbols, definition);
+        }
+    }
+
+    for (uint32_t i = 0; i < sectionCount && valid; i++) {
+        if (sections[i].sh_type != SHT_RELA) continue;
+        valid = sections[i].sh_info < sectionCount && sections[i].sh_link < sectionCount
+            && sections[i].sh_entsize == sizeof(Elf64_Rela);
+        if (!valid || bases[sections[i].sh_info] == LABEL_UNDEFINED) continue;
+
+        const Elf64_Shdr* symbolTable = &sections[sections[i].sh_link];
+        const Elf64_Shdr* strings = symbolTable->sh_link < sectionCount ? &sections[symbolTable->sh_link] : NULL;
+        valid = strings && symbolTable->sh_type == SHT_SYMTAB && strings->sh_type == SHT_STRTAB;
+
+        size_t relocationEntries = valid ? sections[i].sh_size / sizeof(Elf64_Rela) : 0;
+        for (size_t j = 0; j < relocationEntries && valid; j++) {
+            Elf64_Rela relocation;
+            Elf64_Sym symbol;
+            memcpy(&relocation, file->Data + sections[i].sh_offset + j * sizeof(Elf64_Rela), sizeof(relocation));
+            uint32_t type = ELF64_R_TYPE(relocation.r_info);
+            size_t index = ELF64_R_SYM(relocation.r_info);
+
+            // Only calls are linked: a rel32 to a named global symbol, relative to the end of the field.
+            valid = (type == R_X86_64_PLT32 || type == R_X86_64_PC32) && relocation.r_addend == -4
+                && index < symbolTable->sh_size / sizeof(Elf64_Sym)
+                && relocation.r_offset + 4 <= sections[sections[i].sh_info].sh_size;
+            if (!valid) break;
+            memcpy(&symbol, file->Data + symbolTable->sh_offset + index * sizeof(Elf64_Sym), sizeof(symbol));
+            valid = ELF64_ST_BIND(symbol.st_info) == STB_GLOBAL && symbol.st_name < strings->sh_size;
+            if (!valid) break;
+
+            const char* name = file->Data + strings->sh_offset + symbol.st_name;
+            Fixup fixup = {
+                .Offset = bases[sections[i].sh_info] + relocation.r_offset,
+                .Name = symbolName(intern(name, strnlen(name, strings->sh_size - symbol.st_name))),
+            };
+            bufferPush(emitter->SymbolFixups, fixup);
+        }
+    }
+
+    free(bases);
+    free(sections);
+    freeSourceBuffer(file);
+    if (!valid) {
+        freeEmitter(emitter);
+        return NULL;
+    }
+    return emitter;
+}
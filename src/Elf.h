@@ -0,0 +1,39 @@
+#ifndef ELF_H
+#define ELF_H
+
+#include "Common.h"
+#include "Emitter.h"
+
+/*
+    Patch every call in machine code emitted into `emitter` to point at the symbol it names. When a name is defined
+    more than once, the first definition wins.
+
+    Returns false and sets `undefined` to the name when a call refers to a symbol that isn't defined.
+*/
+bool resolveSymbols(Emitter* emitter, const char** undefined);
+
+/*
+    Write resolved machine code as a static x86-64 ELF executable that starts at the symbol `entry`. The code is
+    loaded as a single read-only, executable segment, so no linker is needed.
+
+    Returns false on failure.
+*/
+bool writeExecutable(Emitter* emitter, const char* entry, const char* path);
+
+/*
+    Write machine code as an x86-64 ELF relocatable object: one .text section, a global symbol for every symbol
+    defined in it and a relocation for every call, so calls between objects are resolved when they are linked.
+
+    Returns false on failure.
+*/
+bool writeObject(Emitter* emitter, const char* path);
+
+/*
+    Read the code, global symbols and call relocations of an x86-64 ELF relocatable object into a machine code
+    emitter, to be merged with others by emitEmitter and linked by resolveSymbols. Symbol names are interned.
+
+    Returns NULL on failure or when the object uses relocations other than those of calls.
+*/
+Emitter* readObject(const char* path);
+
+#endif
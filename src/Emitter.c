@@ -0,0 +1,393 @@
+#include "Emitter.h"
+#include "Encoder.h"
+#include "StretchyBuffer.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+const char* REGISTER_TO_STRING[] = {
+    #define REGISTER(r, name, _) [REGISTER_##r] = name,
+    REGISTERS
+    #undef REGISTER
+};
+
+const char* REGISTER_BYTE_TO_STRING[] = {
+    #define REGISTER(r, _, name) [REGISTER_##r] = name,
+    REGISTERS
+    #undef REGISTER
+};
+
+const char* MNEMONIC_TO_STRING[] = {
+    #define MNEMONIC(m, name) [MNEMONIC_##m] = name,
+    MNEMONICS
+    #undef MNEMONIC
+};
+
+static const char* CONDITION_TO_STRING[16] = {
+    #define CONDITION(c, name, _) [CONDITION_##c] = name,
+    CONDITIONS
+    #undef CONDITION
+};
+
+// Two decimal digits at a time, so integers take half as many divisions.
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+Emitter* newEmitter(EmitterFormat format, size_t capacity) {
+    Emitter* emitter = calloc(1, sizeof(Emitter));
+    if (!emitter) return NULL;
+
+    emitter->Format = format;
+    emitter->Sink = -1;
+    emitter->Capacity = capacity > 64 ? capacity : 64;
+    emitter->Data = malloc(emitter->Capacity);
+    emitter->Labels = newStretchyBuffer(sizeof(uint32_t));
+    emitter->LabelFixups = newStretchyBuffer(sizeof(Fixup));
+    emitter->Symbols = newStretchyBuffer(sizeof(SymbolDefinition));
+    emitter->SymbolFixups = newStretchyBuffer(sizeof(Fixup));
+    if (!emitter->Data || !emitter->Labels || !emitter->LabelFixups || !emitter->Symbols || !emitter->SymbolFixups) {
+        freeEmitter(emitter);
+        return NULL;
+    }
+    return emitter;
+}
+
+void freeEmitter(Emitter* emitter) {
+    if (!emitter) return;
+    free(emitter->Data);
+    freeStretchyBuffer(emitter->Labels);
+    freeStretchyBuffer(emitter->LabelFixups);
+    freeStretchyBuffer(emitter->Symbols);
+    freeStretchyBuffer(emitter->SymbolFixups);
+    free(emitter);
+}
+
+static bool writeAll(int file, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(file, data, length);
+        if (written <= 0) return false;
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+bool flushEmitter(Emitter* emitter) {
+    if (emitter->Sink >= 0 && emitter->Length > 0) {
+        emitter->SinkFailed |= !writeAll(emitter->Sink, emitter->Data, emitter->Length);
+        emitter->Length = 0;
+    }
+    return !emitter->SinkFailed;
+}
+
+void streamEmitter(Emitter* emitter, int file) {
+    emitter->Sink = file;
+    emitter->SinkFailed = false;
+}
+
+/*
+    Make room for `length` more bytes and return where they go. A streaming emitter writes out its buffer instead of
+    growing it.
+*/
+static char* reserveBytes(Emitter* emitter, size_t length) {
+    if (emitter->Sink >= 0 && emitter->Length + length > emitter->Capacity) {
+        flushEmitter(emitter);
+    }
+    if (emitter->Length + length > emitter->Capacity) {
+        while (emitter->Length + length > emitter->Capacity) {
+            emitter->Capacity += emitter->Capacity / 2;
+        }
+        emitter->Data = realloc(emitter->Data, emitter->Capacity);
+    }
+
+    char* bytes = emitter->Data + emitter->Length;
+    emitter->Length += length;
+    return bytes;
+}
+
+static void emitCharacter(Emitter* emitter, char c) {
+    *reserveBytes(emitter, 1) = c;
+}
+
+void emitBytes(Emitter* emitter, const char* bytes, size_t length) {
+    // Anything too large for the buffer goes straight to the stream.
+    if (emitter->Sink >= 0 && length > emitter->Capacity) {
+        flushEmitter(emitter);
+        emitter->SinkFailed |= !writeAll(emitter->Sink, bytes, length);
+        return;
+    }
+    memcpy(reserveBytes(emitter, length), bytes, length);
+}
+
+void emitString(Emitter* emitter, const char* string) {
+    emitBytes(emitter, string, strlen(string));
+}
+
+void emitUnsigned(Emitter* emitter, uint64_t value) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    while (value >= 100) {
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + value % 100 * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, DIGIT_PAIRS + value * 2, 2);
+    } else {
+        *--p = '0' + value;
+    }
+    emitBytes(emitter, p, digits + sizeof(digits) - p);
+}
+
+void emitSigned(Emitter* emitter, int64_t value) {
+    if (value < 0) {
+        emitCharacter(emitter, '-');
+        emitUnsigned(emitter, -(uint64_t)value);
+    } else {
+        emitUnsigned(emitter, value);
+    }
+}
+
+void emitEmitter(Emitter* emitter, const Emitter* other) {
+    uint32_t base = emitter->Length;
+    emitBytes(emitter, other->Data, other->Length);
+
+    for (size_t i = 0; i < bufferLength(other->Symbols); i++) {
+        SymbolDefinition symbol = other->Symbols[i];
+        symbol.Offset += base;
+        bufferPush(emitter->Symbols, symbol);
+    }
+    for (size_t i = 0; i < bufferLength(other->SymbolFixups); i++) {
+        Fixup fixup = other->SymbolFixups[i];
+        fixup.Offset += base;
+        bufferPush(emitter->SymbolFixups, fixup);
+    }
+}
+
+static void emitMnemonic(Emitter* emitter, const char* mnemonic) {
+    emitCharacter(emitter, '\t');
+    emitString(emitter, mnemonic);
+}
+
+static void emitMemory(Emitter* emitter, Register base, int32_t offset) {
+    emitCharacter(emitter, '[');
+    emitString(emitter, REGISTER_TO_STRING[base]);
+    if (offset != 0) {
+        emitBytes(emitter, offset < 0 ? " - " : " + ", 3);
+        emitUnsigned(emitter, offset < 0 ? -(int64_t)offset : offset);
+    }
+    emitCharacter(emitter, ']');
+}
+
+static void emitLabelReference(Emitter* emitter, uint32_t label) {
+    emitBytes(emitter, ".L", 2);
+    emitUnsigned(emitter, label);
+}
+
+void emitSymbol(Emitter* emitter, const char* name) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeSymbol(emitter, name);
+        return;
+    }
+
+    // Kept so later code knows which functions the assembly defines.
+    SymbolDefinition symbol = { .Name = name, .Offset = emitter->Length };
+    bufferPush(emitter->Symbols, symbol);
+    emitString(emitter, name);
+    emitBytes(emitter, ":\n", 2);
+}
+
+void emitGlobal(Emitter* emitter, const char* name) {
+    // Machine code has no directives; the entry point is chosen when linking.
+    if (emitter->Format == EMITTER_MACHINE_CODE) return;
+
+    emitBytes(emitter, "global ", 7);
+    emitString(emitter, name);
+    emitCharacter(emitter, '\n');
+}
+
+void emitExtern(Emitter* emitter, const char* name) {
+    // Machine code leaves undefined symbols as fixups for the linker.
+    if (emitter->Format == EMITTER_MACHINE_CODE) return;
+
+    emitBytes(emitter, "extern ", 7);
+    emitString(emitter, name);
+    emitCharacter(emitter, '\n');
+}
+
+void emitLabel(Emitter* emitter, uint32_t label) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeLabel(emitter, label);
+        return;
+    }
+
+    emitLabelReference(emitter, label);
+    emitBytes(emitter, ":\n", 2);
+}
+
+void emitInstruction(Emitter* emitter, Mnemonic mnemonic) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeInstruction(emitter, mnemonic);
+        return;
+    }
+
+    emitMnemonic(emitter, MNEMONIC_TO_STRING[mnemonic]);
+    emitCharacter(emitter, '\n');
+}
+
+void emitRegister(Emitter* emitter, Mnemonic mnemonic, Register reg) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeRegister(emitter, mnemonic, reg);
+        return;
+    }
+
+    emitMnemonic(emitter, MNEMONIC_TO_STRING[mnemonic]);
+    emitCharacter(emitter, ' ');
+    emitString(emitter, REGISTER_TO_STRING[reg]);
+    emitCharacter(emitter, '\n');
+}
+
+void emitImmediate(Emitter* emitter, Mnemonic mnemonic, int64_t immediate) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeImmediate(emitter, mnemonic, immediate);
+        return;
+    }
+
+    emitMnemonic(emitter, MNEMONIC_TO_STRING[mnemonic]);
+    emitCharacter(emitter, ' ');
+    emitSigned(emitter, immediate);
+    emitCharacter(emitter, '\n');
+}
+
+void emitRegisterRegister(Emitter* emitter, Mnemonic mnemonic, Register destination, Register source) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeRegisterRegister(emitter, mnemonic, destination, source);
+        return;
+    }
+
+    emitMnemonic(emitter, MNEMONIC_TO_STRING[mnemonic]);
+    emitCharacter(emitter, ' ');
+    emitString(emitter, REGISTER_TO_STRING[destination]);
+    emitBytes(emitter, ", ", 2);
+    emitString(emitter, REGISTER_TO_STRING[source]);
+    emitCharacter(emitter, '\n');
+}
+
+void emitRegisterImmediate(Emitter* emitter, Mnemonic mnemonic, Register destination, int64_t immediate) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeRegisterImmediate(emitter, mnemonic, destination, immediate);
+        return;
+    }
+
+    emitMnemonic(emitter, MNEMONIC_TO_STRING[mnemonic]);
+    emitCharacter(emitter, ' ');
+    emitString(emitter, REGISTER_TO_STRING[destination]);
+    emitBytes(emitter, ", ", 2);
+    emitSigned(emitter, immediate);
+    emitCharacter(emitter, '\n');
+}
+
+void emitRegisterMemory(Emitter* emitter, Mnemonic mnemonic, Register destination, Register base, int32_t offset) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeRegisterMemory(emitter, mnemonic, destination, base, offset);
+        return;
+    }
+
+    emitMnemonic(emitter, MNEMONIC_TO_STRING[mnemonic]);
+    emitCharacter(emitter, ' ');
+    emitString(emitter, REGISTER_TO_STRING[destination]);
+    emitBytes(emitter, ", ", 2);
+    emitMemory(emitter, base, offset);
+    emitCharacter(emitter, '\n');
+}
+
+void emitMemoryRegister(Emitter* emitter, Mnemonic mnemonic, Register base, int32_t offset, Register source) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeMemoryRegister(emitter, mnemonic, base, offset, source);
+        return;
+    }
+
+    emitMnemonic(emitter, MNEMONIC_TO_STRING[mnemonic]);
+    emitCharacter(emitter, ' ');
+    emitMemory(emitter, base, offset);
+    emitBytes(emitter, ", ", 2);
+    emitString(emitter, REGISTER_TO_STRING[source]);
+    emitCharacter(emitter, '\n');
+}
+
+void emitJump(Emitter* emitter, uint32_t label) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeJump(emitter, label);
+        return;
+    }
+
+    emitMnemonic(emitter, "jmp ");
+    emitLabelReference(emitter, label);
+    emitCharacter(emitter, '\n');
+}
+
+void emitConditionalJump(Emitter* emitter, Condition condition, uint32_t label) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeConditionalJump(emitter, condition, label);
+        return;
+    }
+
+    emitMnemonic(emitter, "j");
+    emitString(emitter, CONDITION_TO_STRING[condition]);
+    emitCharacter(emitter, ' ');
+    emitLabelReference(emitter, label);
+    emitCharacter(emitter, '\n');
+}
+
+void emitCall(Emitter* emitter, const char* name) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeCall(emitter, name);
+        return;
+    }
+
+    emitMnemonic(emitter, "call ");
+    emitString(emitter, name);
+    emitCharacter(emitter, '\n');
+}
+
+void emitReturn(Emitter* emitter, uint32_t popBytes) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeReturn(emitter, popBytes);
+        return;
+    }
+
+    emitMnemonic(emitter, "ret");
+    if (popBytes > 0) {
+        emitCharacter(emitter, ' ');
+        emitUnsigned(emitter, popBytes);
+    }
+    emitCharacter(emitter, '\n');
+}
+
+void emitSetCondition(Emitter* emitter, Condition condition, Register destination) {
+    if (emitter->Format == EMITTER_MACHINE_CODE) {
+        encodeSetCondition(emitter, condition, destination);
+        return;
+    }
+
+    emitMnemonic(emitter, "set");
+    emitString(emitter, CONDITION_TO_STRING[condition]);
+    emitCharacter(emitter, ' ');
+    emitString(emitter, REGISTER_BYTE_TO_STRING[destination]);
+    emitBytes(emitter, "\n\tmovzx ", 8);
+    emitString(emitter, REGISTER_TO_STRING[destination]);
+    emitBytes(emitter, ", ", 2);
+    emitString(emitter, REGISTER_BYTE_TO_STRING[destination]);
+    emitCharacter(emitter, '\n');
+}
+
+bool writeEmitter(Emitter* emitter, const char* path) {
+    int file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) return false;
+
+    // One write normally covers everything; writeAll loops in case it comes back short.
+    bool written = writeAll(file, emitter->Data, emitter->Length);
+    return close(file) == 0 && written;
+}
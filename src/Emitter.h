@@ -0,0 +1,183 @@
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include "Common.h"
+
+#define REGISTERS \
+        REGISTER(RAX, "rax", "al") \
+        REGISTER(RCX, "rcx", "cl") \
+        REGISTER(RDX, "rdx", "dl") \
+        REGISTER(RBX, "rbx", "bl") \
+        REGISTER(RSP, "rsp", "spl") \
+        REGISTER(RBP, "rbp", "bpl") \
+        REGISTER(RSI, "rsi", "sil") \
+        REGISTER(RDI, "rdi", "dil") \
+        REGISTER(R8, "r8", "r8b") \
+        REGISTER(R9, "r9", "r9b") \
+        REGISTER(R10, "r10", "r10b") \
+        REGISTER(R11, "r11", "r11b") \
+        REGISTER(R12, "r12", "r12b") \
+        REGISTER(R13, "r13", "r13b") \
+        REGISTER(R14, "r14", "r14b") \
+        REGISTER(R15, "r15", "r15b") \
+
+// Registers are numbered as in the x86-64 encoding.
+typedef enum Register {
+    #define REGISTER(r, _, __) REGISTER_##r,
+    REGISTERS
+    #undef REGISTER
+    REGISTER_COUNT
+} Register;
+extern const char* REGISTER_TO_STRING[];
+extern const char* REGISTER_BYTE_TO_STRING[];
+
+#define MNEMONICS \
+        MNEMONIC(MOV, "mov") \
+        MNEMONIC(LEA, "lea") \
+        MNEMONIC(PUSH, "push") \
+        MNEMONIC(POP, "pop") \
+        MNEMONIC(ADD, "add") \
+        MNEMONIC(SUB, "sub") \
+        MNEMONIC(IMUL, "imul") \
+        MNEMONIC(IDIV, "idiv") \
+        MNEMONIC(NEG, "neg") \
+        MNEMONIC(XOR, "xor") \
+        MNEMONIC(CMP, "cmp") \
+        MNEMONIC(TEST, "test") \
+        MNEMONIC(CQO, "cqo") \
+        MNEMONIC(SYSCALL, "syscall") \
+
+typedef enum Mnemonic {
+    #define MNEMONIC(m, _) MNEMONIC_##m,
+    MNEMONICS
+    #undef MNEMONIC
+    MNEMONIC_COUNT
+} Mnemonic;
+extern const char* MNEMONIC_TO_STRING[];
+
+// Condition codes of jcc and setcc, numbered as in the x86-64 encoding.
+#define CONDITIONS \
+        CONDITION(EQUAL, "e", 0x4) \
+        CONDITION(NOT_EQUAL, "ne", 0x5) \
+        CONDITION(LESS, "l", 0xC) \
+        CONDITION(GREATER_OR_EQUAL, "ge", 0xD) \
+        CONDITION(LESS_OR_EQUAL, "le", 0xE) \
+        CONDITION(GREATER, "g", 0xF) \
+
+typedef enum Condition {
+    #define CONDITION(c, _, code) CONDITION_##c = code,
+    CONDITIONS
+    #undef CONDITION
+} Condition;
+
+typedef enum EmitterFormat {
+    // NASM syntax text, formatted without going through printf.
+    EMITTER_ASSEMBLY,
+    // x86-64 machine code, see Encoder.h.
+    EMITTER_MACHINE_CODE,
+} EmitterFormat;
+
+// A rel32 field to patch once the local label or symbol it refers to is placed.
+typedef struct Fixup {
+    uint32_t Offset;
+    uint32_t Label;
+    const char* Name;
+} Fixup;
+
+typedef struct SymbolDefinition {
+    const char* Name;
+    uint32_t Offset;
+} SymbolDefinition;
+
+/*
+    Code being built up in memory, either as assembly text or as machine code. Instructions are appended by the
+    emit functions below, which produce the same program in both formats.
+
+    Machine code resolves local labels as soon as they are placed, since they are only visible up to the next
+    symbol. References to symbols are kept as fixups and resolved when the code is linked.
+*/
+typedef struct Emitter {
+    char* Data;
+    size_t Length;
+    size_t Capacity;
+    EmitterFormat Format;
+
+    // Offsets of the current symbol's local labels, LABEL_UNDEFINED until they are placed.
+    uint32_t* Labels;
+    Fixup* LabelFixups;
+    SymbolDefinition* Symbols;
+    Fixup* SymbolFixups;
+
+    // File descriptor assembly is streamed to once the buffer fills up, or -1 to keep everything in memory.
+    int Sink;
+    bool SinkFailed;
+} Emitter;
+
+#define LABEL_UNDEFINED UINT32_MAX
+
+/*
+    Create an emitter with room for `capacity` bytes of code.
+
+    Returns NULL on failure.
+*/
+Emitter* newEmitter(EmitterFormat format, size_t capacity);
+void freeEmitter(Emitter* emitter);
+
+void emitBytes(Emitter* emitter, const char* bytes, size_t length);
+void emitString(Emitter* emitter, const char* string);
+void emitUnsigned(Emitter* emitter, uint64_t value);
+void emitSigned(Emitter* emitter, int64_t value);
+
+/*
+    Append everything emitted to another emitter of the same format, e.g. to merge separately generated functions.
+*/
+void emitEmitter(Emitter* emitter, const Emitter* other);
+
+// `name:`, for functions and other global symbols.
+void emitSymbol(Emitter* emitter, const char* name);
+void emitGlobal(Emitter* emitter, const char* name);
+// `extern name`, for functions assembly calls without defining them.
+void emitExtern(Emitter* emitter, const char* name);
+// `.L<label>:`, local to the last symbol.
+void emitLabel(Emitter* emitter, uint32_t label);
+
+void emitInstruction(Emitter* emitter, Mnemonic mnemonic);
+void emitRegister(Emitter* emitter, Mnemonic mnemonic, Register reg);
+void emitImmediate(Emitter* emitter, Mnemonic mnemonic, int64_t immediate);
+void emitRegisterRegister(Emitter* emitter, Mnemonic mnemonic, Register destination, Register source);
+void emitRegisterImmediate(Emitter* emitter, Mnemonic mnemonic, Register destination, int64_t immediate);
+// `mnemonic destination, [base + offset]`
+void emitRegisterMemory(Emitter* emitter, Mnemonic mnemonic, Register destination, Register base, int32_t offset);
+// `mnemonic [base + offset], source`
+void emitMemoryRegister(Emitter* emitter, Mnemonic mnemonic, Register base, int32_t offset, Register source);
+
+void emitJump(Emitter* emitter, uint32_t label);
+void emitConditionalJump(Emitter* emitter, Condition condition, uint32_t label);
+void emitCall(Emitter* emitter, const char* name);
+// `ret` when `popBytes` is 0, `ret popBytes` otherwise.
+void emitReturn(Emitter* emitter, uint32_t popBytes);
+// `setcc` into the low byte of `destination`, zero-extended to the whole register.
+void emitSetCondition(Emitter* emitter, Condition condition, Register destination);
+
+/*
+    Stream assembly to `file` from now on: whatever is buffered is written out each time the buffer fills up, so the
+    reader can start on it while the rest is generated. Machine code can't be streamed, since jumps and calls are
+    patched after they are emitted.
+*/
+void streamEmitter(Emitter* emitter, int file);
+
+/*
+    Write out what is still buffered for the stream.
+
+    Returns false if any write to the stream failed.
+*/
+bool flushEmitter(Emitter* emitter);
+
+/*
+    Write the emitted code to a file as it is, with a single write.
+
+    Returns false on failure.
+*/
+bool writeEmitter(Emitter* emitter, const char* path);
+
+#endif
@@ -0,0 +1,279 @@
+#include "Encoder.h"
+#include "StretchyBuffer.h"
+#include <string.h>
+
+#define REX 0x40
+#define REX_W 0x08
+#define REX_R 0x04
+#define REX_B 0x01
+
+/*
+    Opcodes of the two-operand instructions: `Store` is `op r/m64, r64`, `Load` is `op r64, r/m64` and `Extension`
+    is the /digit of the `op r/m64, imm` form 0x81 (imm32) or 0x83 (imm8).
+*/
+typedef struct Encoding {
+    uint8_t Store;
+    uint8_t Load;
+    uint8_t Extension;
+} Encoding;
+
+static const Encoding ENCODINGS[MNEMONIC_COUNT] = {
+    [MNEMONIC_MOV] = { .Store = 0x89, .Load = 0x8B },
+    [MNEMONIC_LEA] = { .Load = 0x8D },
+    [MNEMONIC_ADD] = { .Store = 0x01, .Load = 0x03, .Extension = 0 },
+    [MNEMONIC_SUB] = { .Store = 0x29, .Load = 0x2B, .Extension = 5 },
+    [MNEMONIC_XOR] = { .Store = 0x31, .Load = 0x33, .Extension = 6 },
+    [MNEMONIC_CMP] = { .Store = 0x39, .Load = 0x3B, .Extension = 7 },
+    [MNEMONIC_TEST] = { .Store = 0x85, .Load = 0x85 },
+};
+
+static void encodeByte(Emitter* emitter, uint8_t byte) {
+    emitBytes(emitter, (const char*)&byte, 1);
+}
+
+static void encode32(Emitter* emitter, uint32_t value) {
+    uint8_t bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    emitBytes(emitter, (const char*)bytes, 4);
+}
+
+static void encode64(Emitter* emitter, uint64_t value) {
+    encode32(emitter, value);
+    encode32(emitter, value >> 32);
+}
+
+static bool fitsInt8(int64_t value) {
+    return value >= INT8_MIN && value <= INT8_MAX;
+}
+
+static bool fitsInt32(int64_t value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+/*
+    Emit a REX prefix for a ModRM `reg` field and `rm` register, skipping it when it would be empty.
+*/
+static void encodeRex(Emitter* emitter, bool wide, Register reg, Register rm) {
+    uint8_t rex = REX | (wide ? REX_W : 0) | (reg >= REGISTER_R8 ? REX_R : 0) | (rm >= REGISTER_R8 ? REX_B : 0);
+    if (rex != REX) {
+        encodeByte(emitter, rex);
+    }
+}
+
+static void encodeModRMRegister(Emitter* emitter, uint8_t reg, Register rm) {
+    encodeByte(emitter, 0xC0 | (reg & 7) << 3 | (rm & 7));
+}
+
+/*
+    ModRM for [base + offset]. rbp and r13 have no form without a displacement, and rsp and r12 need a SIB byte.
+*/
+static void encodeModRMMemory(Emitter* emitter, uint8_t reg, Register base, int32_t offset) {
+    uint8_t mode = offset == 0 && (base & 7) != REGISTER_RBP ? 0x00 : fitsInt8(offset) ? 0x40 : 0x80;
+    encodeByte(emitter, mode | (reg & 7) << 3 | (base & 7));
+    if ((base & 7) == REGISTER_RSP) {
+        encodeByte(emitter, 0x24);
+    }
+    if (mode == 0x40) {
+        encodeByte(emitter, offset);
+    } else if (mode == 0x80) {
+        encode32(emitter, offset);
+    }
+}
+
+static void patch32(Emitter* emitter, uint32_t offset, uint32_t value) {
+    uint8_t bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    memcpy(emitter->Data + offset, bytes, 4);
+}
+
+/*
+    Emit the rel32 of a jump to a local label, or leave a fixup if the label isn't placed yet. The rel32 is always
+    the last field of the instruction.
+*/
+static void encodeLabelReference(Emitter* emitter, uint32_t label) {
+    uint32_t field = emitter->Length;
+    if (label < bufferLength(emitter->Labels) && emitter->Labels[label] != LABEL_UNDEFINED) {
+        encode32(emitter, emitter->Labels[label] - (field + 4));
+        return;
+    }
+
+    Fixup fixup = { .Offset = field, .Label = label };
+    bufferPush(emitter->LabelFixups, fixup);
+    encode32(emitter, 0);
+}
+
+void encodeSymbol(Emitter* emitter, const char* name) {
+    SymbolDefinition symbol = { .Name = name, .Offset = emitter->Length };
+    bufferPush(emitter->Symbols, symbol);
+
+    // Local labels start over under every symbol.
+    bufferLength(emitter->Labels) = 0;
+    bufferLength(emitter->LabelFixups) = 0;
+}
+
+void encodeLabel(Emitter* emitter, uint32_t label) {
+    while (bufferLength(emitter->Labels) <= label) {
+        bufferPush(emitter->Labels, LABEL_UNDEFINED);
+    }
+    emitter->Labels[label] = emitter->Length;
+
+    for (size_t i = 0; i < bufferLength(emitter->LabelFixups);) {
+        Fixup fixup = emitter->LabelFixups[i];
+        if (fixup.Label == label) {
+            patch32(emitter, fixup.Offset, emitter->Length - (fixup.Offset + 4));
+            emitter->LabelFixups[i] = emitter->LabelFixups[--bufferLength(emitter->LabelFixups)];
+        } else {
+            i++;
+        }
+    }
+}
+
+void encodeInstruction(Emitter* emitter, Mnemonic mnemonic) {
+    switch (mnemonic) {
+        case MNEMONIC_CQO: {
+            encodeByte(emitter, REX | REX_W);
+            encodeByte(emitter, 0x99);
+        } break;
+        case MNEMONIC_SYSCALL: {
+            encodeByte(emitter, 0x0F);
+            encodeByte(emitter, 0x05);
+        } break;
+        default: break;
+    }
+}
+
+void encodeRegister(Emitter* emitter, Mnemonic mnemonic, Register reg) {
+    switch (mnemonic) {
+        case MNEMONIC_PUSH:
+        case MNEMONIC_POP: {
+            encodeRex(emitter, false, 0, reg);
+            encodeByte(emitter, (mnemonic == MNEMONIC_PUSH ? 0x50 : 0x58) + (reg & 7));
+        } break;
+        case MNEMONIC_NEG:
+        case MNEMONIC_IDIV: {
+            encodeRex(emitter, true, 0, reg);
+            encodeByte(emitter, 0xF7);
+            encodeModRMRegister(emitter, mnemonic == MNEMONIC_NEG ? 3 : 7, reg);
+        } break;
+        default: break;
+    }
+}
+
+void encodeImmediate(Emitter* emitter, Mnemonic mnemonic, int64_t immediate) {
+    if (mnemonic != MNEMONIC_PUSH) return;
+
+    // The immediate is sign-extended to 64 bits.
+    if (fitsInt8(immediate)) {
+        encodeByte(emitter, 0x6A);
+        encodeByte(emitter, immediate);
+    } else {
+        encodeByte(emitter, 0x68);
+        encode32(emitter, immediate);
+    }
+}
+
+void encodeRegisterRegister(Emitter* emitter, Mnemonic mnemonic, Register destination, Register source) {
+    if (mnemonic == MNEMONIC_IMUL) {
+        encodeRex(emitter, true, destination, source);
+        encodeByte(emitter, 0x0F);
+        encodeByte(emitter, 0xAF);
+        encodeModRMRegister(emitter, destination, source);
+        return;
+    }
+
+    encodeRex(emitter, true, source, destination);
+    encodeByte(emitter, ENCODINGS[mnemonic].Store);
+    encodeModRMRegister(emitter, source, destination);
+}
+
+void encodeRegisterImmediate(Emitter* emitter, Mnemonic mnemonic, Register destination, int64_t immediate) {
+    switch (mnemonic) {
+        case MNEMONIC_MOV: {
+            if (fitsInt32(immediate)) {
+                encodeRex(emitter, true, 0, destination);
+                encodeByte(emitter, 0xC7);
+                encodeModRMRegister(emitter, 0, destination);
+                encode32(emitter, immediate);
+            } else {
+                encodeRex(emitter, true, 0, destination);
+                encodeByte(emitter, 0xB8 + (destination & 7));
+                encode64(emitter, immediate);
+            }
+        } break;
+        case MNEMONIC_TEST: {
+            encodeRex(emitter, true, 0, destination);
+            encodeByte(emitter, 0xF7);
+            encodeModRMRegister(emitter, 0, destination);
+            encode32(emitter, immediate);
+        } break;
+        default: {
+            encodeRex(emitter, true, 0, destination);
+            encodeByte(emitter, fitsInt8(immediate) ? 0x83 : 0x81);
+            encodeModRMRegister(emitter, ENCODINGS[mnemonic].Extension, destination);
+            if (fitsInt8(immediate)) {
+                encodeByte(emitter, immediate);
+            } else {
+                encode32(emitter, immediate);
+            }
+        } break;
+    }
+}
+
+void encodeRegisterMemory(Emitter* emitter, Mnemonic mnemonic, Register destination, Register base, int32_t offset) {
+    encodeRex(emitter, true, destination, base);
+    if (mnemonic == MNEMONIC_IMUL) {
+        encodeByte(emitter, 0x0F);
+        encodeByte(emitter, 0xAF);
+    } else {
+        encodeByte(emitter, ENCODINGS[mnemonic].Load);
+    }
+    encodeModRMMemory(emitter, destination, base, offset);
+}
+
+void encodeMemoryRegister(Emitter* emitter, Mnemonic mnemonic, Register base, int32_t offset, Register source) {
+    encodeRex(emitter, true, source, base);
+    encodeByte(emitter, ENCODINGS[mnemonic].Store);
+    encodeModRMMemory(emitter, source, base, offset);
+}
+
+void encodeJump(Emitter* emitter, uint32_t label) {
+    encodeByte(emitter, 0xE9);
+    encodeLabelReference(emitter, label);
+}
+
+void encodeConditionalJump(Emitter* emitter, Condition condition, uint32_t label) {
+    encodeByte(emitter, 0x0F);
+    encodeByte(emitter, 0x80 + condition);
+    encodeLabelReference(emitter, label);
+}
+
+void encodeCall(Emitter* emitter, const char* name) {
+    encodeByte(emitter, 0xE8);
+    Fixup fixup = { .Offset = emitter->Length, .Name = name };
+    bufferPush(emitter->SymbolFixups, fixup);
+    encode32(emitter, 0);
+}
+
+void encodeReturn(Emitter* emitter, uint32_t popBytes) {
+    if (popBytes == 0) {
+        encodeByte(emitter, 0xC3);
+        return;
+    }
+
+    encodeByte(emitter, 0xC2);
+    encodeByte(emitter, popBytes);
+    encodeByte(emitter, popBytes >> 8);
+}
+
+void encodeSetCondition(Emitter* emitter, Condition condition, Register destination) {
+    // Without a REX prefix, the byte registers of rsp, rbp, rsi and rdi would be ah, ch, dh and bh.
+    if (destination >= REGISTER_RSP) {
+        encodeByte(emitter, REX | (destination >= REGISTER_R8 ? REX_B : 0));
+    }
+    encodeByte(emitter, 0x0F);
+    encodeByte(emitter, 0x90 + condition);
+    encodeModRMRegister(emitter, 0, destination);
+
+    encodeRex(emitter, true, destination, destination);
+    encodeByte(emitter, 0x0F);
+    encodeByte(emitter, 0xB6);
+    encodeModRMRegister(emitter, destination, destination);
+}
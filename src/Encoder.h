@@ -0,0 +1,29 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "Common.h"
+#include "Emitter.h"
+
+/*
+    x86-64 machine code for the instruction forms of Emitter.h, appended to an EMITTER_MACHINE_CODE emitter. Only
+    64-bit operands are encoded, and jumps and calls always take a rel32, so an instruction's size never depends on
+    where its target ends up.
+*/
+void encodeSymbol(Emitter* emitter, const char* name);
+void encodeLabel(Emitter* emitter, uint32_t label);
+
+void encodeInstruction(Emitter* emitter, Mnemonic mnemonic);
+void encodeRegister(Emitter* emitter, Mnemonic mnemonic, Register reg);
+void encodeImmediate(Emitter* emitter, Mnemonic mnemonic, int64_t immediate);
+void encodeRegisterRegister(Emitter* emitter, Mnemonic mnemonic, Register destination, Register source);
+void encodeRegisterImmediate(Emitter* emitter, Mnemonic mnemonic, Register destination, int64_t immediate);
+void encodeRegisterMemory(Emitter* emitter, Mnemonic mnemonic, Register destination, Register base, int32_t offset);
+void encodeMemoryRegister(Emitter* emitter, Mnemonic mnemonic, Register base, int32_t offset, Register source);
+
+void encodeJump(Emitter* emitter, uint32_t label);
+void encodeConditionalJump(Emitter* emitter, Condition condition, uint32_t label);
+void encodeCall(Emitter* emitter, const char* name);
+void encodeReturn(Emitter* emitter, uint32_t popBytes);
+void encodeSetCondition(Emitter* emitter, Condition condition, Register destination);
+
+#endif
@@ -1,5 +1,5 @@
 #include "Expression.h"
-#include <stdlib.h>
+#include <string.h>
 
 const char* OPERATION_TO_STRING[] = {
     #define OPERATION(op, s) [OPERATION_##op] = s,
@@ -7,58 +7,42 @@ const char* OPERATION_TO_STRING[] = {
     #undef OPERATION
 };
 
-static Expression* newExpression(ExpressionType type) {
-    Expression* expression = calloc(1, sizeof(Expression));
-    expression->Type = type;
-    return expression;
+NodeIndex newIntegerLiteral(Ast* ast, uint64_t value) {
+    return addNode(ast, NODE_INTEGER_LITERAL, (uint32_t)value, (uint32_t)(value >> 32));
 }
-
-static Expression* newLiteral(LiteralType type) {
-    Expression* literal = newExpression(EXPRESSION_LITERAL);
-    literal->Literal.Type = type;
-    return literal;
-}
-
-Expression* newIntegerLiteral(int value) {
-    Expression* literal = newLiteral(LITERAL_INTEGER);
-    literal->Literal.Integer = value;
-    return literal;
+NodeIndex newFloatLiteral(Ast* ast, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return addNode(ast, NODE_FLOAT_LITERAL, (uint32_t)bits, (uint32_t)(bits >> 32));
 }
-Expression* newFloatLiteral(double value) {
-    Expression* literal = newLiteral(LITERAL_FLOAT);
-    literal->Literal.Float = value;
-    return literal;
+NodeIndex newStringLiteral(Ast* ast, Symbol value) {
+    return addNode(ast, NODE_STRING_LITERAL, value, 0);
 }
-Expression* newStringLiteral(const char* value) {
-    Expression* literal = newLiteral(LITERAL_STRING);
-    literal->Literal.String = value;
-    return literal;
-}
-Expression* newUnaryExpression(Operation operation, Expression* expression) {
-    Expression* unary = newExpression(EXPRESSION_UNARY);
-    unary->Unary.Operation = operation;
-    unary->Unary.Expression = expression;
+NodeIndex newUnaryExpression(Ast* ast, Operation operation, NodeIndex operand) {
+    NodeIndex unary = addNode(ast, NODE_UNARY, operand, 0);
+    ast->Operations[unary] = operation;
     return unary;
 }
-Expression* newBinaryExpression(Operation operation, Expression* left, Expression* right) {
-    Expression* binary = newExpression(EXPRESSION_BINARY);
-    binary->Binary.Operation = operation;
-    binary->Binary.Left = left;
-    binary->Binary.Right = right;
+NodeIndex newBinaryExpression(Ast* ast, Operation operation, NodeIndex left, NodeIndex right) {
+    NodeIndex binary = addNode(ast, NODE_BINARY, left, right);
+    ast->Operations[binary] = operation;
     return binary;
 }
-Expression* newFunctionCall(const char* name, Expression** arguments, size_t arity) {
-    Expression* call = newExpression(EXPRESSION_CALL);
-    call->Call.Name = name;
-    call->Call.Arguments = arguments;
-    call->Call.Arity = arity;
-    return call;
+NodeIndex newFunctionCall(Ast* ast, Symbol name, const NodeIndex* arguments, uint32_t arity) {
+    uint32_t extra = addExtra(ast, &arity, 1);
+    addExtra(ast, arguments, arity);
+    return addNode(ast, NODE_CALL, name, extra);
+}
+
+NodeIndex newVariable(Ast* ast, Symbol name) {
+    return addNode(ast, NODE_VARIABLE, name, 0);
 }
 
-Expression* newVariable(const char* name) {
-    Expression* variable = newExpression(EXPRESSION_VARIABLE);
-    variable->Variable = name;
-    return variable;
+double literalFloat(Ast* ast, NodeIndex node) {
+    uint64_t bits = literalInteger(ast, node);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
 /*
@@ -2,8 +2,8 @@
 #define EXPRESSION_H
 
 #include "Common.h"
-
-typedef struct Expression Expression;
+#include "Symbol.h"
+#include "Ast.h"
 
 #define OPERATIONS \
         OPERATION(ADD, "+") \
@@ -26,66 +26,20 @@ typedef enum Operation {
 } Operation;
 extern const char* OPERATION_TO_STRING[];
 
-typedef enum ExpressionType {
-    EXPRESSION_UNKNOWN,
-    EXPRESSION_LITERAL,
-    EXPRESSION_UNARY,
-    EXPRESSION_BINARY,
-    EXPRESSION_CALL,
-    EXPRESSION_VARIABLE
-} ExpressionType;
-
-typedef enum LiteralType {
-    LITERAL_UNKNOWN,
-    LITERAL_INTEGER,
-    LITERAL_FLOAT,
-    LITERAL_STRING
-} LiteralType;
-
-typedef struct Literal {
-    LiteralType Type;
-    union {
-        uint64_t Integer;
-        double Float;
-        const char* String;
-    };
-} Literal;
-
-typedef struct UnaryExpression {
-    Operation Operation;
-    Expression* Expression;
-} UnaryExpression;
-
-typedef struct FunctionCall {
-    const char* Name;
-    size_t Arity;
-    Expression** Arguments;
-} FunctionCall;
-
-typedef struct BinaryExpression {
-    Operation Operation;
-    Expression* Left;
-    Expression* Right;
-} BinaryExpression;
+NodeIndex newIntegerLiteral(Ast* ast, uint64_t value);
+NodeIndex newFloatLiteral(Ast* ast, double value);
+NodeIndex newStringLiteral(Ast* ast, Symbol value);
+NodeIndex newUnaryExpression(Ast* ast, Operation operation, NodeIndex operand);
+NodeIndex newBinaryExpression(Ast* ast, Operation operation, NodeIndex left, NodeIndex right);
+NodeIndex newFunctionCall(Ast* ast, Symbol name, const NodeIndex* arguments, uint32_t arity);
+NodeIndex newVariable(Ast* ast, Symbol name);
 
-struct Expression {
-    ExpressionType Type;
-    union {
-        Literal Literal;
-        UnaryExpression Unary;
-        BinaryExpression Binary;
-        FunctionCall Call;
-        const char* Variable;
-    };
-};
+#define nodeOperation(ast, node) ((Operation)(ast)->Operations[node])
+#define callArity(ast, node) (nodeExtra(ast, node)[0])
+#define callArguments(ast, node) (nodeExtra(ast, node) + 1)
+#define literalInteger(ast, node) ((uint64_t)(ast)->First[node] | (uint64_t)(ast)->Second[node] << 32)
 
-Expression* newIntegerLiteral(int value);
-Expression* newFloatLiteral(double value);
-Expression* newStringLiteral(const char* value);
-Expression* newUnaryExpression(Operation operation, Expression* expression);
-Expression* newBinaryExpression(Operation operation, Expression* left, Expression* right);
-Expression* newFunctionCall(const char* name, Expression** arguments, size_t arity);
-Expression* newVariable(const char* name);
+double literalFloat(Ast* ast, NodeIndex node);
 
 int operatorPrecedence(Operation operation);
 
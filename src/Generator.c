@@ -1,158 +1,754 @@
 #include "Generator.h"
+#include "Allocator.h"
+#include "Ir.h"
 #include "Node.h"
-#include <stdio.h>
+#include "StretchyBuffer.h"
 #include <stdlib.h>
+#include <string.h>
 
-static void generateExpression(Generator* generator, Expression* expression);
-static void generateStatement(Generator* generator, Statement* statement);
-static void generateDeclaration(Generator* generator, Declaration* declaration);
+// Label of every function's epilogue.
+#define RETURN_LABEL 0
 
-Generator* newGenerator(const char* filepath) {
+// The System V calling convention passes the first arguments in registers and the rest on the stack.
+static const Register ARGUMENT_REGISTERS[] = {
+    REGISTER_RDI, REGISTER_RSI, REGISTER_RDX, REGISTER_RCX, REGISTER_R8, REGISTER_R9,
+};
+#define ARGUMENT_REGISTER_COUNT (sizeof(ARGUMENT_REGISTERS) / sizeof(ARGUMENT_REGISTERS[0]))
+
+// Bytes below rsp a function that makes no calls can use without moving rsp.
+#define RED_ZONE_SIZE 128
+
+Generator* newGenerator(EmitterFormat format) {
     Generator* generator = calloc(1, sizeof(Generator));
-    generator->Output = fopen(filepath, "w");
+    generator->Output = newEmitter(format, 64 * 1024);
+    generator->Function = newIrFunction();
+    generator->Values = newStretchyBuffer(sizeof(LiveInterval));
+    generator->Intervals = newStretchyBuffer(sizeof(uint32_t));
+    generator->LastUses = newStretchyBuffer(sizeof(IrValue));
+    generator->Calls = newStretchyBuffer(sizeof(uint32_t));
     return generator;
 }
 
 void freeGenerator(Generator* generator) {
+    freeEmitter(generator->Output);
+    freeIrFunction(generator->Function);
+    freeStretchyBuffer(generator->Values);
+    freeStretchyBuffer(generator->Intervals);
+    freeStretchyBuffer(generator->LastUses);
+    freeStretchyBuffer(generator->Calls);
     free(generator);
 }
 
-static void generatePreamble(Generator* generator) {
-    fputs( 
-    "global _start\n"
-    "_start:\n"
-    "\tmov rbp, rsp\n"
-    "\tmov rdi, rsi\n"
-    "\n"
-    "\tmov rdi, [rbp]\n"
-    "\tlea rsi, [rbp + 8]\n"
-    "\tpush rdi\n"
-    "\tpush rsi\n"
-    "\tcall main\n"
-    "\tmov rdi, rax\n"
-    "\tmov rax, 60\n"
-    "\tsyscall\n"
-    "printInteger:\n"
-    "\tpush rbp\n"
-    "\tmov rbp, rsp\n"
-    "\tmov rdi, [rbp + 16]\n"
-    "\ttest rdi, rdi\n"
-    "\tjge .L1\n"
-    "\tpush rdi\n"
-    "\tpush '-'\n"
-    "\tcall printCharacter\n"
-    "\tpop rdi\n"
-    "\tneg rdi\n"
-    ".L1:\n"
-    "\tmov rax, rdi\n"
-    "\tmov rsi, 10\n"
-    "\tcqo\n"
-    "\tidiv rsi\n"
-    "\tmov rdi, rdx\n"
-    "\ttest rax, rax\n"
-    "\tjz .L2\n"
-    "\tpush rdi\n"
-    "\tpush rax\n"
-    "\tcall printInteger\n"
-    "\tpop rdi\n"
-    ".L2:\n"
-    "\tadd rdi, '0'\n"
-    "\tpush rdi\n"
-    "\tcall printCharacter\n"
-    "\tpop rbp\n"
-    "\tret 8\n"
-    , generator->Output);
+/*
+    `_start` passes argc and argv to main and exits with its result;
+    printCharacter(character) writes one byte to stdout and printInteger(value) prints a signed integer one digit at
+    a time through it. Both follow the System V calling convention like generated functions.
+*/
+void generateRuntime(Generator* generator) {
+    Emitter* output = generator->Output;
+    emitGlobal(output, "_start");
+    emitSymbol(output, "_start");
+    emitRegisterMemory(output, MNEMONIC_MOV, REGISTER_RDI, REGISTER_RSP, 0);
+    emitRegisterMemory(output, MNEMONIC_LEA, REGISTER_RSI, REGISTER_RSP, 8);
+    emitCall(output, "main");
+    emitRegisterRegister(output, MNEMONIC_MOV, REGISTER_RDI, REGISTER_RAX);
+    emitRegisterImmediate(output, MNEMONIC_MOV, REGISTER_RAX, 60);
+    emitInstruction(output, MNEMONIC_SYSCALL);
+
+    // The character is written from the red zone.
+    emitSymbol(output, "printCharacter");
+    emitMemoryRegister(output, MNEMONIC_MOV, REGISTER_RSP, -8, REGISTER_RDI);
+    emitRegisterMemory(output, MNEMONIC_LEA, REGISTER_RSI, REGISTER_RSP, -8);
+    emitRegisterImmediate(output, MNEMONIC_MOV, REGISTER_RAX, 1);
+    emitRegisterImmediate(output, MNEMONIC_MOV, REGISTER_RDI, 1);
+    emitRegisterImmediate(output, MNEMONIC_MOV, REGISTER_RDX, 1);
+    emitInstruction(output, MNEMONIC_SYSCALL);
+    emitReturn(output, 0);
+
+    // The digit is kept in rbx across the calls, and saving it aligns the stack for them.
+    emitSymbol(output, "printInteger");
+    emitRegister(output, MNEMONIC_PUSH, REGISTER_RBX);
+    emitRegisterRegister(output, MNEMONIC_MOV, REGISTER_RBX, REGISTER_RDI);
+    emitRegisterRegister(output, MNEMONIC_TEST, REGISTER_RBX, REGISTER_RBX);
+    emitConditionalJump(output, CONDITION_GREATER_OR_EQUAL, 1);
+    emitRegisterImmediate(output, MNEMONIC_MOV, REGISTER_RDI, '-');
+    emitCall(output, "printCharacter");
+    emitRegister(output, MNEMONIC_NEG, REGISTER_RBX);
+    emitLabel(output, 1);
+    emitRegisterRegister(output, MNEMONIC_MOV, REGISTER_RAX, REGISTER_RBX);
+    emitRegisterImmediate(output, MNEMONIC_MOV, REGISTER_RCX, 10);
+    emitInstruction(output, MNEMONIC_CQO);
+    emitRegister(output, MNEMONIC_IDIV, REGISTER_RCX);
+    emitRegisterRegister(output, MNEMONIC_MOV, REGISTER_RBX, REGISTER_RDX);
+    emitRegisterRegister(output, MNEMONIC_TEST, REGISTER_RAX, REGISTER_RAX);
+    emitConditionalJump(output, CONDITION_EQUAL, 2);
+    emitRegisterRegister(output, MNEMONIC_MOV, REGISTER_RDI, REGISTER_RAX);
+    emitCall(output, "printInteger");
+    emitLabel(output, 2);
+    emitRegisterMemory(output, MNEMONIC_LEA, REGISTER_RDI, REGISTER_RBX, '0');
+    emitCall(output, "printCharacter");
+    emitRegister(output, MNEMONIC_POP, REGISTER_RBX);
+    emitReturn(output, 0);
 }
 static void generatePostamble(Generator* generator) {}
 
-static void generateFunction(Generator* generator, Declaration* functionDeclaration) {
-    FunctionDeclaration function = functionDeclaration->Function;
-
-    fprintf(generator->Output, "%s:\n", functionDeclaration->Name);
-    fputs(
-        "\tpush rbp\n"
-        "\tmov rbp, rsp\n"
-    , generator->Output);
-    StatementBlock* block = function.Block->Block;
-    for (int i = 0; i < block->Count; i++) {
-        Statement* statement = block->Statements[i];
-        generateStatement(generator, statement);
-    }
-
-    fputs(
-        "\tmov rsp, rbp\n"
-        "\tpop rbp\n"
-    , generator->Output);
-    if (function.Arity > 0) {
-        fprintf(generator->Output, "\tret %lu\n", function.Arity * 8);
-    } else {
-        fprintf(generator->Output, "\tret\n");
+static Condition comparisonCondition(IrOpcode opcode) {
+    switch (opcode) {
+        case IR_OPCODE_GREATER: return CONDITION_GREATER;
+        case IR_OPCODE_GREATER_OR_EQUAL: return CONDITION_GREATER_OR_EQUAL;
+        case IR_OPCODE_LESS: return CONDITION_LESS;
+        case IR_OPCODE_LESS_OR_EQUAL: return CONDITION_LESS_OR_EQUAL;
+        case IR_OPCODE_EQUAL: return CONDITION_EQUAL;
+        default: return CONDITION_NOT_EQUAL;
     }
 }
 
-static void generateFunctionCall(Generator* generator, FunctionCall call) {
-    for (int i = 0; i < call.Arity; i++) {
-        Expression* argument = call.Arguments[i];
-        switch (argument->Type) {
-            case EXPRESSION_LITERAL: {
-                Literal literal = argument->Literal;
-                switch (literal.Type) {
-                    case LITERAL_INTEGER: {
-                        fprintf(generator->Output, "\tpush %lu\n", literal.Integer);
-                    } break;
+// Condition codes come in pairs of opposites that only differ in their lowest bit.
+static Condition invertCondition(Condition condition) {
+    return condition ^ 1;
+}
+
+// Every block gets a label, after the one of the epilogue.
+static uint32_t blockLabel(IrBlock block) {
+    return RETURN_LABEL + 1 + block;
+}
+
+/*
+    A comparison whose only use is the branch right after it is generated as part of the branch, so its result
+    never needs to be materialized.
+*/
+static bool isFusedComparison(Generator* generator, IrValue value) {
+    IrFunction* function = generator->Function;
+    return irIsComparison(irOpcode(function, value)) && generator->LastUses[value] == value + 1
+        && irOpcode(function, value + 1) == IR_OPCODE_BRANCH && irFirst(function, value + 1) == value;
+}
+
+/*
+    Liveness. Branches only go forward, so a value is live from its definition to its last use in instruction
+    order. Constants are used as immediates and values that are never used aren't computed, so neither gets a live
+    interval.
+*/
+static void findLiveIntervals(Generator* generator) {
+    IrFunction* function = generator->Function;
+    uint32_t count = irInstructionCount(function);
+    bufferLength(generator->LastUses) = 0;
+    for (IrValue value = 0; value < count; value++) {
+        bufferPush(generator->LastUses, 0);
+    }
+    for (IrValue value = 0; value < count; value++) {
+        switch (irOpcode(function, value)) {
+            case IR_OPCODE_CONSTANT:
+            case IR_OPCODE_PARAMETER:
+            case IR_OPCODE_JUMP: break;
+            case IR_OPCODE_EXTEND:
+            case IR_OPCODE_BRANCH: {
+                generator->LastUses[irFirst(function, value)] = value;
+            } break;
+            case IR_OPCODE_RETURN: {
+                if (irFirst(function, value) != IR_NONE) {
+                    generator->LastUses[irFirst(function, value)] = value;
                 }
             } break;
-        } break;
+            case IR_OPCODE_CALL: {
+                for (uint32_t i = 0; i < irCallArity(function, value); i++) {
+                    generator->LastUses[irCallArguments(function, value)[i]] = value;
+                }
+            } break;
+            default: {
+                generator->LastUses[irFirst(function, value)] = value;
+                generator->LastUses[irSecond(function, value)] = value;
+            } break;
+        }
+    }
+
+    bufferLength(generator->Values) = 0;
+    bufferLength(generator->Intervals) = 0;
+    bufferLength(generator->Calls) = 0;
+    for (IrValue value = 0; value < count; value++) {
+        IrOpcode opcode = irOpcode(function, value);
+        bufferPush(generator->Intervals, INTERVAL_NONE);
+        if (opcode == IR_OPCODE_CALL) {
+            bufferPush(generator->Calls, value);
+            // Arguments would rather already be in the register they are passed in.
+            for (uint32_t i = 0; i < irCallArity(function, value) && i < ARGUMENT_REGISTER_COUNT; i++) {
+                uint32_t argument = generator->Intervals[irCallArguments(function, value)[i]];
+                if (argument != INTERVAL_NONE && generator->Values[argument].Hint == REGISTER_NONE) {
+                    generator->Values[argument].Hint = ARGUMENT_REGISTERS[i];
+                }
+            }
+        }
+        if (generator->LastUses[value] == 0 || opcode == IR_OPCODE_CONSTANT || isFusedComparison(generator, value)) {
+            continue;
+        }
+
+        // Parameters are all defined on entry.
+        LiveInterval interval = {
+            .Start = opcode == IR_OPCODE_PARAMETER ? 0 : value,
+            .End = generator->LastUses[value],
+            .Hint = REGISTER_NONE,
+            .Source = INTERVAL_NONE,
+        };
+        if (opcode == IR_OPCODE_PARAMETER && irFirst(function, value) < ARGUMENT_REGISTER_COUNT) {
+            interval.Hint = ARGUMENT_REGISTERS[irFirst(function, value)];
+        } else if (opcode == IR_OPCODE_ADD || opcode == IR_OPCODE_SUBTRACT || opcode == IR_OPCODE_MULTIPLY
+            || opcode == IR_OPCODE_EXTEND) {
+            interval.Source = generator->Intervals[irFirst(function, value)];
+            if (interval.Source == INTERVAL_NONE && opcode != IR_OPCODE_SUBTRACT && opcode != IR_OPCODE_EXTEND) {
+                interval.Source = generator->Intervals[irSecond(function, value)];
+            }
+        }
+        bufferPush(generator->Values, interval);
+        generator->Intervals[value] = bufferLength(generator->Values) - 1;
     }
-    fprintf(generator->Output, "\tcall %s\n", call.Name);
 }
 
-static void generateExpression(Generator* generator, Expression* expression) {
-    switch (expression->Type) {
-        case EXPRESSION_CALL: {
-            generateFunctionCall(generator, expression->Call);
-        } break;
+/*
+    Mark the values live across a call. Calls are numbered in increasing order, so the first call after a value's
+    definition is found by binary search.
+*/
+static void markCallCrossings(Generator* generator) {
+    size_t callCount = bufferLength(generator->Calls);
+    for (size_t i = 0; i < bufferLength(generator->Values); i++) {
+        LiveInterval* interval = &generator->Values[i];
+        size_t low = 0;
+        size_t high = callCount;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (generator->Calls[middle] <= interval->Start) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        interval->CrossesCall = low < callCount && generator->Calls[low] < interval->End;
     }
 }
 
-static void generateDeclaration(Generator* generator, Declaration* declaration) {
-    switch (declaration->Type) {
-        case DECLARATION_FUNCTION: {
-            generateFunction(generator, declaration);
-        } break;
+/*
+    Offset from Base of a spilled value. Spilled parameters passed on the stack stay where the caller put them; other
+    values get a slot below the saved registers.
+*/
+static int32_t valueOffset(Generator* generator, IrValue value) {
+    IrFunction* function = generator->Function;
+    if (irOpcode(function, value) == IR_OPCODE_PARAMETER && irFirst(function, value) >= ARGUMENT_REGISTER_COUNT) {
+        // Above the return address, and the saved rbp when there is a frame.
+        int32_t arguments = generator->Base == REGISTER_RBP ? 16 : 8;
+        return arguments + (irFirst(function, value) - ARGUMENT_REGISTER_COUNT) * 8;
     }
+    return -(int32_t)((generator->SavedRegisters + generator->Values[generator->Intervals[value]].Slot + 1) * 8);
 }
 
-static void generateStatement(Generator* generator, Statement* statement) {
-    switch (statement->Type) {
-        case STATEMENT_DECLARATION: {
-            generateDeclaration(generator, statement->Declaration);
+typedef enum OperandKind {
+    OPERAND_REGISTER,
+    OPERAND_MEMORY,
+    OPERAND_IMMEDIATE,
+} OperandKind;
+
+// Where an instruction finds one of its operands.
+typedef struct Operand {
+    OperandKind Kind;
+    Register Register;
+    int32_t Offset;
+    int64_t Immediate;
+} Operand;
+
+static Operand valueOperand(Generator* generator, IrValue value) {
+    if (irOpcode(generator->Function, value) == IR_OPCODE_CONSTANT) {
+        return (Operand) { .Kind = OPERAND_IMMEDIATE, .Immediate = irConstant(generator->Function, value) };
+    }
+    Register reg = generator->Values[generator->Intervals[value]].Register;
+    if (reg != REGISTER_NONE) {
+        return (Operand) { .Kind = OPERAND_REGISTER, .Register = reg };
+    }
+    return (Operand) { .Kind = OPERAND_MEMORY, .Register = generator->Base, .Offset = valueOffset(generator, value) };
+}
+
+/*
+    `mnemonic destination, operand`. Immediates that don't fit in 32 bits only go straight into mov and are
+    otherwise loaded into rcx first.
+*/
+static void emitOperand(Generator* generator, Mnemonic mnemonic, Register destination, Operand operand) {
+    switch (operand.Kind) {
+        case OPERAND_REGISTER: {
+            if (mnemonic != MNEMONIC_MOV || operand.Register != destination) {
+                emitRegisterRegister(generator->Output, mnemonic, destination, operand.Register);
+            }
+        } break;
+        case OPERAND_MEMORY: {
+            emitRegisterMemory(generator->Output, mnemonic, destination, operand.Register, operand.Offset);
         } break;
-        case STATEMENT_EXPRESSION: {
-            generateExpression(generator, statement->Expresssion);
+        case OPERAND_IMMEDIATE: {
+            if (mnemonic != MNEMONIC_MOV && (operand.Immediate < INT32_MIN || operand.Immediate > INT32_MAX)) {
+                emitRegisterImmediate(generator->Output, MNEMONIC_MOV, REGISTER_RCX, operand.Immediate);
+                emitRegisterRegister(generator->Output, mnemonic, destination, REGISTER_RCX);
+            } else {
+                emitRegisterImmediate(generator->Output, mnemonic, destination, operand.Immediate);
+            }
         } break;
     }
 }
 
-static void generateNode(Generator* generator, Node* node) {
-    switch (node->Type) {
-        case NODE_STATEMENT: {
-            generateStatement(generator, node->Statement);
+/*
+    Register to compute a value in: its own, or rax when it is spilled.
+*/
+static Register resultRegister(Generator* generator, IrValue value) {
+    uint32_t interval = generator->Intervals[value];
+    if (interval == INTERVAL_NONE || generator->Values[interval].Register == REGISTER_NONE) return REGISTER_RAX;
+    return generator->Values[interval].Register;
+}
+
+/*
+    Move a value computed in `source` to where it lives, unless it is never used.
+*/
+static void storeResult(Generator* generator, IrValue value, Register source) {
+    if (generator->Intervals[value] == INTERVAL_NONE) return;
+
+    Operand location = valueOperand(generator, value);
+    if (location.Kind != OPERAND_REGISTER) {
+        emitMemoryRegister(generator->Output, MNEMONIC_MOV, location.Register, location.Offset, source);
+    } else if (location.Register != source) {
+        emitRegisterRegister(generator->Output, MNEMONIC_MOV, location.Register, source);
+    }
+}
+
+typedef struct Move {
+    Register Destination;
+    Operand Source;
+} Move;
+
+/*
+    Perform moves into distinct registers as if they all happened at once. Register sources are moved first, in an
+    order that reads every register before it is overwritten, with rax breaking cycles. Loads and immediates read no
+    register another move writes, so they come last.
+*/
+static void emitMoves(Generator* generator, Move* moves, uint32_t count) {
+    uint32_t pending = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        pending += moves[i].Source.Kind == OPERAND_REGISTER && moves[i].Source.Register != moves[i].Destination;
+    }
+    bool done[ARGUMENT_REGISTER_COUNT] = { 0 };
+    while (pending > 0) {
+        bool moved = false;
+        for (uint32_t i = 0; i < count; i++) {
+            Move* move = &moves[i];
+            if (done[i] || move->Source.Kind != OPERAND_REGISTER || move->Source.Register == move->Destination) continue;
+
+            bool read = false;
+            for (uint32_t j = 0; j < count && !read; j++) {
+                read = j != i && !done[j] && moves[j].Source.Kind == OPERAND_REGISTER
+                    && moves[j].Source.Register == move->Destination;
+            }
+            if (read) continue;
+
+            emitRegisterRegister(generator->Output, MNEMONIC_MOV, move->Destination, move->Source.Register);
+            done[i] = true;
+            pending--;
+            moved = true;
+        }
+        if (moved) continue;
+
+        // Every pending move is part of a cycle. Copying one source into rax frees its register.
+        for (uint32_t i = 0; i < count; i++) {
+            if (done[i] || moves[i].Source.Kind != OPERAND_REGISTER || moves[i].Source.Register == moves[i].Destination) continue;
+            emitRegisterRegister(generator->Output, MNEMONIC_MOV, REGISTER_RAX, moves[i].Source.Register);
+            moves[i].Source.Register = REGISTER_RAX;
+            break;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (moves[i].Source.Kind != OPERAND_REGISTER) {
+            emitOperand(generator, MNEMONIC_MOV, moves[i].Destination, moves[i].Source);
+        }
+    }
+}
+
+/*
+    Call with the System V calling convention: the arguments passed on the stack are pushed and the rest are moved
+    into the argument registers.
+*/
+static void generateCall(Generator* generator, IrValue call) {
+    Emitter* output = generator->Output;
+    IrFunction* function = generator->Function;
+    uint32_t arity = irCallArity(function, call);
+    const IrValue* arguments = irCallArguments(function, call);
+
+    // The stack stays 16 byte aligned at the call.
+    uint32_t stackArguments = arity > ARGUMENT_REGISTER_COUNT ? arity - ARGUMENT_REGISTER_COUNT : 0;
+    uint32_t padding = stackArguments % 2 * 8;
+    if (padding > 0) {
+        emitRegisterImmediate(output, MNEMONIC_SUB, REGISTER_RSP, padding);
+    }
+    for (uint32_t i = arity; i-- > ARGUMENT_REGISTER_COUNT;) {
+        Operand operand = valueOperand(generator, arguments[i]);
+        if (operand.Kind == OPERAND_IMMEDIATE && operand.Immediate >= INT32_MIN && operand.Immediate <= INT32_MAX) {
+            emitImmediate(output, MNEMONIC_PUSH, operand.Immediate);
+        } else if (operand.Kind == OPERAND_REGISTER) {
+            emitRegister(output, MNEMONIC_PUSH, operand.Register);
+        } else {
+            emitOperand(generator, MNEMONIC_MOV, REGISTER_RAX, operand);
+            emitRegister(output, MNEMONIC_PUSH, REGISTER_RAX);
+        }
+    }
+
+    Move moves[ARGUMENT_REGISTER_COUNT];
+    uint32_t moveCount = 0;
+    for (uint32_t i = 0; i < arity && i < ARGUMENT_REGISTER_COUNT; i++) {
+        moves[moveCount++] = (Move) { .Destination = ARGUMENT_REGISTERS[i], .Source = valueOperand(generator, arguments[i]) };
+    }
+    emitMoves(generator, moves, moveCount);
+
+    emitCall(output, symbolName(irFirst(function, call)));
+    if (stackArguments > 0) {
+        emitRegisterImmediate(output, MNEMONIC_ADD, REGISTER_RSP, stackArguments * 8 + padding);
+    }
+    storeResult(generator, call, REGISTER_RAX);
+}
+
+/*
+    Compare the operands of a comparison, leaving the result in the flags.
+*/
+static void generateComparison(Generator* generator, IrValue comparison) {
+    Operand left = valueOperand(generator, irFirst(generator->Function, comparison));
+    if (left.Kind != OPERAND_REGISTER) {
+        emitOperand(generator, MNEMONIC_MOV, REGISTER_RAX, left);
+        left = (Operand) { .Kind = OPERAND_REGISTER, .Register = REGISTER_RAX };
+    }
+    emitOperand(generator, MNEMONIC_CMP, left.Register, valueOperand(generator, irSecond(generator->Function, comparison)));
+}
+
+static void generateArithmetic(Generator* generator, IrValue value) {
+    IrFunction* function = generator->Function;
+    IrOpcode opcode = irOpcode(function, value);
+    Operand left = valueOperand(generator, irFirst(function, value));
+    Operand right = valueOperand(generator, irSecond(function, value));
+    if (opcode == IR_OPCODE_DIVIDE) {
+        emitOperand(generator, MNEMONIC_MOV, REGISTER_RAX, left);
+        if (right.Kind != OPERAND_REGISTER) {
+            emitOperand(generator, MNEMONIC_MOV, REGISTER_RCX, right);
+            right = (Operand) { .Kind = OPERAND_REGISTER, .Register = REGISTER_RCX };
+        }
+        emitInstruction(generator->Output, MNEMONIC_CQO);
+        emitRegister(generator->Output, MNEMONIC_IDIV, right.Register);
+        storeResult(generator, value, REGISTER_RAX);
+        return;
+    }
+
+    // Two-address form: the result register gets the left operand, then the right one is applied to it. When the
+    // result shares the right operand's register, the operands swap if the order doesn't matter.
+    Register result = resultRegister(generator, value);
+    bool leftInResult = left.Kind == OPERAND_REGISTER && left.Register == result;
+    if (right.Kind == OPERAND_REGISTER && right.Register == result && !leftInResult) {
+        if (opcode == IR_OPCODE_SUBTRACT) {
+            result = REGISTER_RAX;
+        } else {
+            Operand swapped = left;
+            left = right;
+            right = swapped;
+        }
+    }
+    emitOperand(generator, MNEMONIC_MOV, result, left);
+    switch (opcode) {
+        case IR_OPCODE_ADD: emitOperand(generator, MNEMONIC_ADD, result, right); break;
+        case IR_OPCODE_SUBTRACT: emitOperand(generator, MNEMONIC_SUB, result, right); break;
+        default: {
+            // imul has no two-operand immediate form.
+            if (right.Kind == OPERAND_IMMEDIATE) {
+                emitRegisterImmediate(generator->Output, MNEMONIC_MOV, REGISTER_RCX, right.Immediate);
+                right = (Operand) { .Kind = OPERAND_REGISTER, .Register = REGISTER_RCX };
+            }
+            emitOperand(generator, MNEMONIC_IMUL, result, right);
         } break;
-        case NODE_DECLARATION: {
-            generateDeclaration(generator, node->Declaration);
+    }
+    storeResult(generator, value, result);
+}
+
+static void generateBranch(Generator* generator, IrValue branch, IrBlock block) {
+    IrFunction* function = generator->Function;
+    IrValue condition = irFirst(function, branch);
+    Condition taken = CONDITION_NOT_EQUAL;
+    if (isFusedComparison(generator, condition)) {
+        generateComparison(generator, condition);
+        taken = comparisonCondition(irOpcode(function, condition));
+    } else {
+        Operand operand = valueOperand(generator, condition);
+        if (operand.Kind != OPERAND_REGISTER) {
+            emitOperand(generator, MNEMONIC_MOV, REGISTER_RAX, operand);
+            operand = (Operand) { .Kind = OPERAND_REGISTER, .Register = REGISTER_RAX };
+        }
+        emitRegisterRegister(generator->Output, MNEMONIC_TEST, operand.Register, operand.Register);
+    }
+
+    // Fall through to whichever target comes next.
+    IrBlock then = irBranchTarget(function, branch, true);
+    IrBlock otherwise = irBranchTarget(function, branch, false);
+    if (then == block + 1) {
+        emitConditionalJump(generator->Output, invertCondition(taken), blockLabel(otherwise));
+    } else {
+        emitConditionalJump(generator->Output, taken, blockLabel(then));
+        if (otherwise != block + 1) {
+            emitJump(generator->Output, blockLabel(otherwise));
+        }
+    }
+}
+
+static void generateInstruction(Generator* generator, IrValue value, IrBlock block) {
+    IrFunction* function = generator->Function;
+    IrOpcode opcode = irOpcode(function, value);
+    switch (opcode) {
+        // Constants are used as immediates and parameters are moved into place by the prologue.
+        case IR_OPCODE_CONSTANT:
+        case IR_OPCODE_PARAMETER: break;
+        case IR_OPCODE_CALL: {
+            generateCall(generator, value);
         } break;
-        case NODE_PROGRAM: {
-            ProgramNode* program = node->Program;
-            for (size_t i = 0; i < program->Count; i++) {
-                Node* node = program->Nodes[i];
-                generateNode(generator, node);
+        case IR_OPCODE_JUMP: {
+            if (irFirst(function, value) != block + 1) {
+                emitJump(generator->Output, blockLabel(irFirst(function, value)));
+            }
+        } break;
+        case IR_OPCODE_BRANCH: {
+            generateBranch(generator, value, block);
+        } break;
+        case IR_OPCODE_RETURN: {
+            if (irFirst(function, value) != IR_NONE) {
+                emitOperand(generator, MNEMONIC_MOV, REGISTER_RAX, valueOperand(generator, irFirst(function, value)));
+            }
+            // The last block runs into the epilogue.
+            if (block + 1 < irBlockCount(function)) {
+                emitJump(generator->Output, RETURN_LABEL);
+                generator->Returns = true;
+            }
+        } break;
+        default: {
+            // Values that are never used have no side effects and aren't computed.
+            if (generator->Intervals[value] == INTERVAL_NONE) break;
+
+            if (opcode == IR_OPCODE_EXTEND) {
+                Register result = resultRegister(generator, value);
+                emitOperand(generator, MNEMONIC_MOV, result, valueOperand(generator, irFirst(function, value)));
+                storeResult(generator, value, result);
+            } else if (irIsComparison(opcode)) {
+                Register result = resultRegister(generator, value);
+                generateComparison(generator, value);
+                emitSetCondition(generator->Output, comparisonCondition(opcode), result);
+                storeResult(generator, value, result);
+            } else {
+                generateArithmetic(generator, value);
             }
         } break;
     }
 }
 
-void generate(Generator* generator, Node* node) {
-    generatePreamble(generator);
-    generateNode(generator, node);
-}
\ No newline at end of file
+/*
+    Emit a function from its IR. Labels are numbered per function from RETURN_LABEL up and are local to the
+    function's own label, so functions can be generated independently of each other.
+
+    The frame holds rbp, then the callee-saved registers the function uses, then the slots of spilled values. A
+    function that makes no calls and whose saved registers and slots fit in the red zone keeps them below rsp
+    without setting up a frame.
+*/
+static void generateFunction(Generator* generator, Ast* ast, NodeIndex declaration) {
+    IrFunction* function = generator->Function;
+    lowerFunction(function, ast, declaration);
+    findLiveIntervals(generator);
+    markCallCrossings(generator);
+    Allocation allocation = allocateRegisters(generator->Values, bufferLength(generator->Values));
+
+    uint32_t savedRegisters = allocation.UsedRegisters & CALLEE_SAVED_REGISTERS;
+    generator->SavedRegisters = __builtin_popcount(savedRegisters);
+    generator->Returns = false;
+    bool leaf = bufferLength(generator->Calls) == 0
+        && (generator->SavedRegisters + allocation.SlotCount) * 8 <= RED_ZONE_SIZE;
+    generator->Base = leaf ? REGISTER_RSP : REGISTER_RBP;
+
+    Emitter* output = generator->Output;
+    emitSymbol(output, symbolName(function->Name));
+    if (leaf) {
+        int32_t offset = 0;
+        for (Register reg = 0; reg < REGISTER_COUNT; reg++) {
+            if (savedRegisters & REGISTER_MASK(reg)) {
+                offset -= 8;
+                emitMemoryRegister(output, MNEMONIC_MOV, REGISTER_RSP, offset, reg);
+            }
+        }
+    } else {
+        emitRegister(output, MNEMONIC_PUSH, REGISTER_RBP);
+        emitRegisterRegister(output, MNEMONIC_MOV, REGISTER_RBP, REGISTER_RSP);
+        for (Register reg = 0; reg < REGISTER_COUNT; reg++) {
+            if (savedRegisters & REGISTER_MASK(reg)) {
+                emitRegister(output, MNEMONIC_PUSH, reg);
+            }
+        }
+        // Calls need rsp 16 byte aligned, which it is right after pushing rbp.
+        uint32_t frameSlots = allocation.SlotCount + (generator->SavedRegisters + allocation.SlotCount) % 2;
+        if (frameSlots > 0) {
+            emitRegisterImmediate(output, MNEMONIC_SUB, REGISTER_RSP, frameSlots * 8);
+        }
+    }
+
+    // Parameters are the first instructions. Spilled register parameters are stored before any argument register
+    // is overwritten, and parameters passed on the stack are loaded once every argument register has been read.
+    Move moves[ARGUMENT_REGISTER_COUNT];
+    uint32_t moveCount = 0;
+    for (IrValue parameter = 0; parameter < function->Arity && parameter < ARGUMENT_REGISTER_COUNT; parameter++) {
+        if (generator->Intervals[parameter] == INTERVAL_NONE) continue;
+
+        Register reg = generator->Values[generator->Intervals[parameter]].Register;
+        if (reg == REGISTER_NONE) {
+            storeResult(generator, parameter, ARGUMENT_REGISTERS[parameter]);
+        } else {
+            Operand source = { .Kind = OPERAND_REGISTER, .Register = ARGUMENT_REGISTERS[parameter] };
+            moves[moveCount++] = (Move) { .Destination = reg, .Source = source };
+        }
+    }
+    emitMoves(generator, moves, moveCount);
+    for (IrValue parameter = ARGUMENT_REGISTER_COUNT; parameter < function->Arity; parameter++) {
+        if (generator->Intervals[parameter] == INTERVAL_NONE) continue;
+
+        Register reg = generator->Values[generator->Intervals[parameter]].Register;
+        if (reg != REGISTER_NONE) {
+            emitRegisterMemory(output, MNEMONIC_MOV, reg, generator->Base, valueOffset(generator, parameter));
+        }
+    }
+
+    for (IrBlock block = 0; block < irBlockCount(function); block++) {
+        if (block > 0) {
+            emitLabel(output, blockLabel(block));
+        }
+        for (IrValue value = irBlockStart(function, block); value < irBlockEnd(function, block); value++) {
+            generateInstruction(generator, value, block);
+        }
+    }
+
+    if (generator->Returns) {
+        emitLabel(output, RETURN_LABEL);
+    }
+    if (leaf) {
+        int32_t offset = 0;
+        for (Register reg = 0; reg < REGISTER_COUNT; reg++) {
+            if (savedRegisters & REGISTER_MASK(reg)) {
+                offset -= 8;
+                emitRegisterMemory(output, MNEMONIC_MOV, reg, REGISTER_RSP, offset);
+            }
+        }
+    } else {
+        if (generator->SavedRegisters > 0) {
+            emitRegisterMemory(output, MNEMONIC_LEA, REGISTER_RSP, REGISTER_RBP, -(int32_t)generator->SavedRegisters * 8);
+            for (Register reg = REGISTER_COUNT; reg-- > 0;) {
+                if (savedRegisters & REGISTER_MASK(reg)) {
+                    emitRegister(output, MNEMONIC_POP, reg);
+                }
+            }
+        } else {
+            emitRegisterRegister(output, MNEMONIC_MOV, REGISTER_RSP, REGISTER_RBP);
+        }
+        emitRegister(output, MNEMONIC_POP, REGISTER_RBP);
+    }
+    emitReturn(output, 0);
+}
+
+static int compareSymbols(const void* left, const void* right) {
+    Symbol a = *(const Symbol*)left;
+    Symbol b = *(const Symbol*)right;
+    return (a > b) - (a < b);
+}
+
+/*
+    Declare every function of the program global and every function it calls without defining it extern, so its
+    assembly can be assembled into an object of its own and linked with others. Functions already in the output,
+    such as the runtime, count as defined.
+*/
+static void generateDeclarations(Generator* generator, Ast* ast, const NodeIndex* functions, uint32_t count) {
+    Emitter* output = generator->Output;
+    Symbol* defined = newStretchyBuffer(sizeof(Symbol));
+    for (uint32_t i = 0; i < count; i++) {
+        emitGlobal(output, symbolName(nodeFirst(ast, functions[i])));
+        bufferPush(defined, nodeFirst(ast, functions[i]));
+    }
+    for (size_t i = 0; i < bufferLength(output->Symbols); i++) {
+        bufferPush(defined, intern(output->Symbols[i].Name, strlen(output->Symbols[i].Name)));
+    }
+
+    // Bodies that were never parsed aren't generated, so their calls don't matter.
+    Symbol* called = newStretchyBuffer(sizeof(Symbol));
+    for (NodeIndex node = 0; node < ast->Count; node++) {
+        if (nodeKind(ast, node) == NODE_CALL) {
+            bufferPush(called, nodeFirst(ast, node));
+        }
+    }
+
+    qsort(defined, bufferLength(defined), sizeof(Symbol), compareSymbols);
+    qsort(called, bufferLength(called), sizeof(Symbol), compareSymbols);
+    for (size_t i = 0; i < bufferLength(called); i++) {
+        if (i > 0 && called[i] == called[i - 1]) continue;
+        if (bsearch(&called[i], defined, bufferLength(defined), sizeof(Symbol), compareSymbols)) continue;
+        emitExtern(output, symbolName(called[i]));
+    }
+    freeStretchyBuffer(defined);
+    freeStretchyBuffer(called);
+}
+
+// Fewest functions worth handing to a worker.
+#define PARALLEL_BATCH_MINIMUM 256
+
+typedef struct GenerateBatch {
+    Ast* Ast;
+    const NodeIndex* Functions;
+    uint32_t FunctionCount;
+    Generator* Generator;
+} GenerateBatch;
+
+static void generateBatch(void* argument) {
+    GenerateBatch* batch = argument;
+    for (uint32_t i = 0; i < batch->FunctionCount; i++) {
+        generateFunction(batch->Generator, batch->Ast, batch->Functions[i]);
+    }
+}
+
+void generateParallel(Generator* generator, Ast* ast, NodeIndex program, ThreadPool* pool) {
+    NodeIndex* functions = newStretchyBuffer(sizeof(NodeIndex));
+    collectFunctions(ast, program, &functions);
+    uint32_t functionCount = bufferLength(functions);
+    if (generator->Output->Format == EMITTER_ASSEMBLY) {
+        generateDeclarations(generator, ast, functions, functionCount);
+    }
+
+    // Several batches per worker even out functions of different sizes.
+    uint32_t batchCount = pool ? pool->ThreadCount * 4 : 1;
+    if (functionCount / PARALLEL_BATCH_MINIMUM < batchCount) {
+        batchCount = functionCount / PARALLEL_BATCH_MINIMUM;
+    }
+    if (batchCount < 1) {
+        batchCount = 1;
+    }
+
+    GenerateBatch* batches = calloc(batchCount, sizeof(GenerateBatch));
+    for (uint32_t i = 0; i < batchCount; i++) {
+        uint32_t first = (uint64_t)functionCount * i / batchCount;
+        uint32_t end = (uint64_t)functionCount * (i + 1) / batchCount;
+        batches[i] = (GenerateBatch) { .Ast = ast, .Functions = functions + first, .FunctionCount = end - first };
+    }
+
+    if (batchCount > 1) {
+        for (uint32_t i = 0; i < batchCount; i++) {
+            batches[i].Generator = newGenerator(generator->Output->Format);
+            submitTask(pool, generateBatch, &batches[i]);
+        }
+        waitForTasks(pool);
+        for (uint32_t i = 0; i < batchCount; i++) {
+            emitEmitter(generator->Output, batches[i].Generator->Output);
+            freeGenerator(batches[i].Generator);
+        }
+    } else {
+        batches[0].Generator = generator;
+        generateBatch(&batches[0]);
+    }
+    generatePostamble(generator);
+
+    free(batches);
+    freeStretchyBuffer(functions);
+}
+
+void generate(Generator* generator, Ast* ast, NodeIndex program) {
+    generateParallel(generator, ast, program, NULL);
+}
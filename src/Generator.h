@@ -3,15 +3,52 @@
 
 #include "Common.h"
 #include "Node.h"
-#include <stdio.h>
+#include "ThreadPool.h"
+#include "Emitter.h"
+#include "Allocator.h"
+#include "Ir.h"
 
 typedef struct Generator {
-    FILE* Output;
+    Emitter* Output;
+    // State of the function being generated.
+    IrFunction* Function;
+    // Live interval of every value kept in a register or stack slot, in the order they are defined.
+    LiveInterval* Values;
+    // Index in Values of every instruction's value, or INTERVAL_NONE.
+    uint32_t* Intervals;
+    // Last instruction using every value, or 0 when it is never used.
+    IrValue* LastUses;
+    // Positions of the calls, in increasing order.
+    uint32_t* Calls;
+    // rbp, or rsp in leaf functions that address their values in the red zone instead of setting up a frame.
+    Register Base;
+    uint32_t SavedRegisters;
+    bool Returns;
 } Generator;
 
-Generator* newGenerator(const char* filepath);
+/*
+    Create a generator that emits assembly or machine code into memory. The caller writes Output wherever it needs
+    to go.
+*/
+Generator* newGenerator(EmitterFormat format);
 void freeGenerator(Generator* generator);
 
-void generate(Generator* generator, Node* node);
+/*
+    Emit the program entry and the runtime functions every program calls into. Programs are either generated after
+    the runtime or linked with an object of it.
+*/
+void generateRuntime(Generator* generator);
+
+/*
+    Generate every parsed function of a program. Calls to functions it doesn't define are left to the linker.
+*/
+void generate(Generator* generator, Ast* ast, NodeIndex program);
+
+/*
+    Generate the program like generate, with the functions split into batches that are generated into memory on the
+    workers of `pool`. The batches are written out in declaration order, so the output doesn't depend on the number
+    of threads.
+*/
+void generateParallel(Generator* generator, Ast* ast, NodeIndex program, ThreadPool* pool);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,648 @@
+#include "Ir.h"
+#include <stdlib.h>
+
+const char* IR_TYPE_TO_STRING[] = {
+    #define IR_TYPE(t, name) [IR_TYPE_##t] = name,
+    IR_TYPES
+    #undef IR_TYPE
+};
+
+const char* IR_OPCODE_TO_STRING[] = {
+    #define IR_OPCODE(o, name) [IR_OPCODE_##o] = name,
+    IR_OPCODES
+    #undef IR_OPCODE
+};
+
+IrFunction* newIrFunction(void) {
+    IrFunction* function = calloc(1, sizeof(IrFunction));
+    function->Opcodes = newStretchyBuffer(sizeof(uint8_t));
+    function->Types = newStretchyBuffer(sizeof(uint8_t));
+    function->First = newStretchyBuffer(sizeof(uint32_t));
+    function->Second = newStretchyBuffer(sizeof(uint32_t));
+    function->Extra = newStretchyBuffer(sizeof(uint32_t));
+    function->Blocks = newStretchyBuffer(sizeof(uint32_t));
+    function->Bindings = newStretchyBuffer(sizeof(IrBinding));
+    function->Arguments = newStretchyBuffer(sizeof(IrValue));
+    function->Renumbered = newStretchyBuffer(sizeof(IrValue));
+    return function;
+}
+
+void freeIrFunction(IrFunction* function) {
+    if (!function) return;
+    freeStretchyBuffer(function->Opcodes);
+    freeStretchyBuffer(function->Types);
+    freeStretchyBuffer(function->First);
+    freeStretchyBuffer(function->Second);
+    freeStretchyBuffer(function->Extra);
+    freeStretchyBuffer(function->Blocks);
+    freeStretchyBuffer(function->Bindings);
+    freeStretchyBuffer(function->Arguments);
+    freeStretchyBuffer(function->Renumbered);
+    free(function);
+}
+
+static IrValue addInstruction(IrFunction* function, IrOpcode opcode, IrType type, uint32_t first, uint32_t second) {
+    bufferPush(function->Opcodes, opcode);
+    bufferPush(function->Types, type);
+    bufferPush(function->First, first);
+    bufferPush(function->Second, second);
+    return irInstructionCount(function) - 1;
+}
+
+static IrValue addConstant(IrFunction* function, int64_t value) {
+    return addInstruction(function, IR_OPCODE_CONSTANT, IR_TYPE_INT, (uint64_t)value, (uint64_t)value >> 32);
+}
+
+static IrValue addBoolean(IrFunction* function, bool value) {
+    return addInstruction(function, IR_OPCODE_CONSTANT, IR_TYPE_BOOL, value, 0);
+}
+
+static bool isConstant(IrFunction* function, IrValue value) {
+    return irOpcode(function, value) == IR_OPCODE_CONSTANT;
+}
+
+static bool isConstantOf(IrFunction* function, IrValue value, int64_t constant) {
+    return isConstant(function, value) && irConstant(function, value) == constant;
+}
+
+static IrBlock startBlock(IrFunction* function) {
+    bufferPush(function->Blocks, irInstructionCount(function));
+    return bufferLength(function->Blocks) - 1;
+}
+
+static IrValue asInteger(IrFunction* function, IrValue value) {
+    if (irType(function, value) != IR_TYPE_BOOL) return value;
+    if (isConstant(function, value)) return addConstant(function, irConstant(function, value));
+    return addInstruction(function, IR_OPCODE_EXTEND, IR_TYPE_INT, value, 0);
+}
+
+static IrValue asCondition(IrFunction* function, IrValue value) {
+    if (irType(function, value) == IR_TYPE_BOOL) return value;
+    if (isConstant(function, value)) return addBoolean(function, irConstant(function, value) != 0);
+    return addInstruction(function, IR_OPCODE_NOT_EQUAL, IR_TYPE_BOOL, value, addConstant(function, 0));
+}
+
+/*
+    Evaluate an operation while lowering when its operands allow it, with the results the generated code would
+    give: arithmetic wraps around, and dividing by zero or the smallest integer by -1 is left to trap at run time.
+    The operands are lowered already, so dropping one never skips a call.
+
+    Returns IR_NONE if the operation has to be done at run time.
+*/
+static IrValue foldOperation(IrFunction* function, IrOpcode opcode, IrValue left, IrValue right) {
+    if (isConstant(function, left) && isConstant(function, right)) {
+        int64_t a = irConstant(function, left);
+        int64_t b = irConstant(function, right);
+        switch (opcode) {
+            case IR_OPCODE_ADD: return addConstant(function, (int64_t)((uint64_t)a + (uint64_t)b));
+            case IR_OPCODE_SUBTRACT: return addConstant(function, (int64_t)((uint64_t)a - (uint64_t)b));
+            case IR_OPCODE_MULTIPLY: return addConstant(function, (int64_t)((uint64_t)a * (uint64_t)b));
+            case IR_OPCODE_DIVIDE: {
+                if (b != 0 && !(a == INT64_MIN && b == -1)) return addConstant(function, a / b);
+            } break;
+            case IR_OPCODE_GREATER: return addBoolean(function, a > b);
+            case IR_OPCODE_GREATER_OR_EQUAL: return addBoolean(function, a >= b);
+            case IR_OPCODE_LESS: return addBoolean(function, a < b);
+            case IR_OPCODE_LESS_OR_EQUAL: return addBoolean(function, a <= b);
+            case IR_OPCODE_EQUAL: return addBoolean(function, a == b);
+            case IR_OPCODE_NOT_EQUAL: return addBoolean(function, a != b);
+            default: break;
+        }
+        return IR_NONE;
+    }
+
+    switch (opcode) {
+        case IR_OPCODE_ADD: {
+            if (isConstantOf(function, left, 0)) return right;
+            if (isConstantOf(function, right, 0)) return left;
+        } break;
+        case IR_OPCODE_SUBTRACT: {
+            if (isConstantOf(function, right, 0)) return left;
+            if (left == right) return addConstant(function, 0);
+        } break;
+        case IR_OPCODE_MULTIPLY: {
+            if (isConstantOf(function, left, 1) || isConstantOf(function, right, 0)) return right;
+            if (isConstantOf(function, right, 1) || isConstantOf(function, left, 0)) return left;
+        } break;
+        case IR_OPCODE_DIVIDE: {
+            if (isConstantOf(function, right, 1)) return left;
+        } break;
+        default: {
+            // A value compared with itself.
+            if (irIsComparison(opcode) && left == right) {
+                return addBoolean(function, opcode == IR_OPCODE_GREATER_OR_EQUAL || opcode == IR_OPCODE_LESS_OR_EQUAL
+                    || opcode == IR_OPCODE_EQUAL);
+            }
+        } break;
+    }
+    return IR_NONE;
+}
+
+static IrValue lowerExpression(IrFunction* function, Ast* ast, NodeIndex expression) {
+    switch (nodeKind(ast, expression)) {
+        case NODE_INTEGER_LITERAL: return addConstant(function, literalInteger(ast, expression));
+        case NODE_VARIABLE: {
+            for (size_t i = bufferLength(function->Bindings); i > 0; i--) {
+                if (function->Bindings[i - 1].Name == nodeFirst(ast, expression)) return function->Bindings[i - 1].Value;
+            }
+            return addConstant(function, 0);
+        }
+        case NODE_BINARY: {
+            // Operands are evaluated left to right, since calls may print.
+            Operation operation = nodeOperation(ast, expression);
+            IrValue left = asInteger(function, lowerExpression(function, ast, nodeFirst(ast, expression)));
+            IrValue right = asInteger(function, lowerExpression(function, ast, nodeSecond(ast, expression)));
+            if (operation == OPERATION_UNKNOWN) return addConstant(function, 0);
+
+            IrOpcode opcode = IR_OPCODE_ADD + (operation - OPERATION_ADD);
+            IrValue folded = foldOperation(function, opcode, left, right);
+            if (folded != IR_NONE) return folded;
+            return addInstruction(function, opcode, irIsComparison(opcode) ? IR_TYPE_BOOL : IR_TYPE_INT, left, right);
+        }
+        case NODE_CALL: {
+            uint32_t arity = callArity(ast, expression);
+            size_t first = bufferLength(function->Arguments);
+            for (uint32_t i = 0; i < arity; i++) {
+                IrValue argument = lowerExpression(function, ast, callArguments(ast, expression)[i]);
+                bufferPush(function->Arguments, asInteger(function, argument));
+            }
+
+            uint32_t extra = bufferLength(function->Extra);
+            bufferPush(function->Extra, arity);
+            for (uint32_t i = 0; i < arity; i++) {
+                bufferPush(function->Extra, function->Arguments[first + i]);
+            }
+            bufferLength(function->Arguments) = first;
+            return addInstruction(function, IR_OPCODE_CALL, IR_TYPE_INT, nodeFirst(ast, expression), extra);
+        }
+        default: return addConstant(function, 0);
+    }
+}
+
+static bool lowerStatement(IrFunction* function, Ast* ast, NodeIndex statement);
+
+/*
+    Lower the statements of a block up to the first one that doesn't fall through.
+
+    Returns false if control never reaches the end of the block.
+*/
+static bool lowerBlock(IrFunction* function, Ast* ast, NodeIndex block) {
+    if (nodeKind(ast, block) != NODE_BLOCK) return true;
+
+    size_t scope = bufferLength(function->Bindings);
+    bool reachable = true;
+    for (uint32_t i = 0; i < blockCount(ast, block) && reachable; i++) {
+        reachable = lowerStatement(function, ast, blockStatements(ast, block)[i]);
+    }
+    bufferLength(function->Bindings) = scope;
+    return reachable;
+}
+
+static bool lowerIfStatement(IrFunction* function, Ast* ast, NodeIndex statement) {
+    IrValue condition = asCondition(function, lowerExpression(function, ast, nodeFirst(ast, statement)));
+    // Only one branch of a constant condition can run, and it stays in the current block.
+    if (isConstant(function, condition)) {
+        NodeIndex taken = irConstant(function, condition) ? ifBlock(ast, statement) : ifElseBlock(ast, statement);
+        return !taken || lowerBlock(function, ast, taken);
+    }
+    uint32_t targets = bufferLength(function->Extra);
+    bufferPush(function->Extra, 0);
+    bufferPush(function->Extra, 0);
+    addInstruction(function, IR_OPCODE_BRANCH, IR_TYPE_VOID, condition, targets);
+
+    function->Extra[targets] = startBlock(function);
+    IrValue thenJump = IR_NONE;
+    if (lowerBlock(function, ast, ifBlock(ast, statement))) {
+        thenJump = addInstruction(function, IR_OPCODE_JUMP, IR_TYPE_VOID, 0, 0);
+    }
+
+    IrValue elseJump = IR_NONE;
+    if (ifElseBlock(ast, statement)) {
+        function->Extra[targets + 1] = startBlock(function);
+        if (lowerBlock(function, ast, ifElseBlock(ast, statement))) {
+            elseJump = addInstruction(function, IR_OPCODE_JUMP, IR_TYPE_VOID, 0, 0);
+        }
+        // Both branches returned, so there is nothing to join.
+        if (thenJump == IR_NONE && elseJump == IR_NONE) return false;
+    }
+
+    IrBlock join = startBlock(function);
+    if (!ifElseBlock(ast, statement)) {
+        function->Extra[targets + 1] = join;
+    }
+    if (thenJump != IR_NONE) {
+        function->First[thenJump] = join;
+    }
+    if (elseJump != IR_NONE) {
+        function->First[elseJump] = join;
+    }
+    return true;
+}
+
+static bool lowerStatement(IrFunction* function, Ast* ast, NodeIndex statement) {
+    switch (nodeKind(ast, statement)) {
+        case NODE_VARIABLE_DECLARATION: {
+            // The initializer still sees any variable the declaration shadows.
+            IrValue value = nodeSecond(ast, statement)
+                ? lowerExpression(function, ast, nodeSecond(ast, statement))
+                : addConstant(function, 0);
+            IrBinding binding = { .Name = nodeFirst(ast, statement), .Value = value };
+            bufferPush(function->Bindings, binding);
+        } break;
+        case NODE_EXPRESSION_STATEMENT: {
+            lowerExpression(function, ast, nodeFirst(ast, statement));
+        } break;
+        case NODE_BLOCK: return lowerBlock(function, ast, statement);
+        case NODE_IF: return lowerIfStatement(function, ast, statement);
+        case NODE_RETURN: {
+            IrValue value = asInteger(function, lowerExpression(function, ast, nodeFirst(ast, statement)));
+            addInstruction(function, IR_OPCODE_RETURN, IR_TYPE_VOID, value, 0);
+        } return false;
+        // Nested functions are lowered on their own.
+        default: break;
+    }
+    return true;
+}
+
+/*
+    Remove the instructions whose values are never used and that have no effect, such as the operands of folded
+    operations. Values are only used after they are defined, so a backward pass finds every unused one.
+*/
+static void removeUnusedValues(IrFunction* function) {
+    uint32_t count = irInstructionCount(function);
+    bufferLength(function->Renumbered) = 0;
+    for (IrValue value = 0; value < count; value++) {
+        bufferPush(function->Renumbered, IR_NONE);
+    }
+    IrValue* renumbered = function->Renumbered;
+
+    for (IrValue value = count; value-- > 0;) {
+        IrOpcode opcode = irOpcode(function, value);
+        bool effect = opcode == IR_OPCODE_PARAMETER || opcode == IR_OPCODE_CALL || irType(function, value) == IR_TYPE_VOID;
+        if (!effect && renumbered[value] == IR_NONE) continue;
+
+        // Any number other than IR_NONE marks a value as used until the values are renumbered.
+        renumbered[value] = 0;
+        switch (opcode) {
+            case IR_OPCODE_CONSTANT:
+            case IR_OPCODE_PARAMETER:
+            case IR_OPCODE_JUMP: break;
+            case IR_OPCODE_CALL: {
+                for (uint32_t i = 0; i < irCallArity(function, value); i++) {
+                    renumbered[irCallArguments(function, value)[i]] = 0;
+                }
+            } break;
+            case IR_OPCODE_EXTEND:
+            case IR_OPCODE_BRANCH:
+            case IR_OPCODE_RETURN: {
+                if (irFirst(function, value) != IR_NONE) {
+                    renumbered[irFirst(function, value)] = 0;
+                }
+            } break;
+            default: {
+                renumbered[irFirst(function, value)] = 0;
+                renumbered[irSecond(function, value)] = 0;
+            } break;
+        }
+    }
+
+    uint32_t kept = 0;
+    IrBlock block = 0;
+    for (IrValue value = 0; value < count; value++) {
+        while (function->Blocks[block] == value) {
+            function->Blocks[block++] = kept;
+        }
+        if (renumbered[value] == IR_NONE) continue;
+
+        IrOpcode opcode = irOpcode(function, value);
+        renumbered[value] = kept;
+        function->Opcodes[kept] = opcode;
+        function->Types[kept] = function->Types[value];
+        function->First[kept] = function->First[value];
+        function->Second[kept] = function->Second[value];
+        switch (opcode) {
+            case IR_OPCODE_CONSTANT:
+            case IR_OPCODE_PARAMETER:
+            case IR_OPCODE_JUMP: break;
+            case IR_OPCODE_CALL: {
+                for (uint32_t i = 0; i < irCallArity(function, kept); i++) {
+                    irCallArguments(function, kept)[i] = renumbered[irCallArguments(function, kept)[i]];
+                }
+            } break;
+            case IR_OPCODE_EXTEND:
+            case IR_OPCODE_BRANCH:
+            case IR_OPCODE_RETURN: {
+                if (irFirst(function, kept) != IR_NONE) {
+                    function->First[kept] = renumbered[irFirst(function, kept)];
+                }
+            } break;
+            default: {
+                function->First[kept] = renumbered[irFirst(function, kept)];
+                function->Second[kept] = renumbered[irSecond(function, kept)];
+            } break;
+        }
+        kept++;
+    }
+    // Blocks always end in a terminator, so only the end of the last one is left.
+    function->Blocks[block] = kept;
+    bufferLength(function->Opcodes) = kept;
+    bufferLength(function->Types) = kept;
+    bufferLength(function->First) = kept;
+    bufferLength(function->Second) = kept;
+}
+
+void lowerFunction(IrFunction* function, Ast* ast, NodeIndex declaration) {
+    bufferLength(function->Opcodes) = 0;
+    bufferLength(function->Types) = 0;
+    bufferLength(function->First) = 0;
+    bufferLength(function->Second) = 0;
+    bufferLength(function->Extra) = 0;
+    bufferLength(function->Blocks) = 0;
+    bufferLength(function->Bindings) = 0;
+    function->Name = nodeFirst(ast, declaration);
+    function->Arity = functionArity(ast, declaration);
+
+    startBlock(function);
+    for (uint32_t i = 0; i < function->Arity; i++) {
+        IrBinding parameter = {
+            .Name = nodeFirst(ast, functionParameters(ast, declaration)[i]),
+            .Value = addInstruction(function, IR_OPCODE_PARAMETER, IR_TYPE_INT, i, 0),
+        };
+        bufferPush(function->Bindings, parameter);
+    }
+    if (lowerBlock(function, ast, functionBlock(ast, declaration))) {
+        addInstruction(function, IR_OPCODE_RETURN, IR_TYPE_VOID, IR_NONE, 0);
+    }
+    bufferPush(function->Blocks, irInstructionCount(function));
+    bufferLength(function->Bindings) = 0;
+    removeUnusedValues(function);
+}
+
+static IrType resultType(IrOpcode opcode) {
+    switch (opcode) {
+        case IR_OPCODE_JUMP:
+        case IR_OPCODE_BRANCH:
+        case IR_OPCODE_RETURN: return IR_TYPE_VOID;
+        default: return irIsComparison(opcode) ? IR_TYPE_BOOL : IR_TYPE_INT;
+    }
+}
+
+static bool isTerminator(IrOpcode opcode) {
+    return resultType(opcode) == IR_TYPE_VOID;
+}
+
+typedef struct Verifier {
+    IrFunction* Function;
+    // Block of every instruction, and the immediate dominator of every block.
+    IrBlock* BlockOf;
+    IrBlock* Dominators;
+    char* Message;
+    size_t Size;
+} Verifier;
+
+static bool dominates(Verifier* verifier, IrBlock dominator, IrBlock block) {
+    // Dominators always come before the blocks they dominate.
+    while (block > dominator) {
+        block = verifier->Dominators[block];
+    }
+    return block == dominator;
+}
+
+static bool checkOperand(Verifier* verifier, IrValue user, IrValue operand, IrType type) {
+    IrFunction* function = verifier->Function;
+    if (operand >= irInstructionCount(function) || irType(function, operand) == IR_TYPE_VOID) {
+        snprintf(verifier->Message, verifier->Size, "%%%u: operand %%%u of %s is not a value",
+            user, operand, IR_OPCODE_TO_STRING[irOpcode(function, user)]);
+        return false;
+    }
+    IrBlock definition = verifier->BlockOf[operand];
+    IrBlock use = verifier->BlockOf[user];
+    if (definition == use ? operand >= user : !dominates(verifier, definition, use)) {
+        snprintf(verifier->Message, verifier->Size, "%%%u: operand %%%u of %s does not dominate its use",
+            user, operand, IR_OPCODE_TO_STRING[irOpcode(function, user)]);
+        return false;
+    }
+    if (irType(function, operand) != type) {
+        snprintf(verifier->Message, verifier->Size, "%%%u: operand %%%u of %s has type %s, expected %s",
+            user, operand, IR_OPCODE_TO_STRING[irOpcode(function, user)],
+            IR_TYPE_TO_STRING[irType(function, operand)], IR_TYPE_TO_STRING[type]);
+        return false;
+    }
+    return true;
+}
+
+static bool checkTarget(Verifier* verifier, IrValue user, IrBlock target) {
+    IrFunction* function = verifier->Function;
+    if (target <= verifier->BlockOf[user] || target >= irBlockCount(function)) {
+        snprintf(verifier->Message, verifier->Size, "%%%u: %s to b%u, which is not a later block",
+            user, IR_OPCODE_TO_STRING[irOpcode(function, user)], target);
+        return false;
+    }
+    return true;
+}
+
+/*
+    Find the immediate dominator of every block. Branches only go forward, so the blocks are in topological order
+    and each block's predecessors are done before it.
+*/
+static bool findDominators(Verifier* verifier) {
+    IrFunction* function = verifier->Function;
+    uint32_t blockCount = irBlockCount(function);
+    for (IrBlock block = 1; block < blockCount; block++) {
+        verifier->Dominators[block] = IR_NONE;
+    }
+    verifier->Dominators[0] = 0;
+
+    for (IrBlock block = 0; block < blockCount; block++) {
+        if (verifier->Dominators[block] == IR_NONE) {
+            snprintf(verifier->Message, verifier->Size, "b%u is unreachable", block);
+            return false;
+        }
+        IrValue terminator = irBlockEnd(function, block) - 1;
+        IrBlock successors[2];
+        uint32_t successorCount = 0;
+        if (irOpcode(function, terminator) == IR_OPCODE_JUMP) {
+            successors[successorCount++] = irFirst(function, terminator);
+        } else if (irOpcode(function, terminator) == IR_OPCODE_BRANCH) {
+            successors[successorCount++] = irBranchTarget(function, terminator, true);
+            successors[successorCount++] = irBranchTarget(function, terminator, false);
+        }
+
+        for (uint32_t i = 0; i < successorCount; i++) {
+            if (!checkTarget(verifier, terminator, successors[i])) return false;
+            IrBlock* dominator = &verifier->Dominators[successors[i]];
+            if (*dominator == IR_NONE) {
+                *dominator = block;
+                continue;
+            }
+            IrBlock other = block;
+            while (*dominator != other) {
+                if (*dominator > other) {
+                    *dominator = verifier->Dominators[*dominator];
+                } else {
+                    other = verifier->Dominators[other];
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool checkInstruction(Verifier* verifier, IrValue value) {
+    IrFunction* function = verifier->Function;
+    IrOpcode opcode = irOpcode(function, value);
+    bool boolean = opcode == IR_OPCODE_CONSTANT && irType(function, value) == IR_TYPE_BOOL;
+    if (irType(function, value) != resultType(opcode) && !boolean) {
+        snprintf(verifier->Message, verifier->Size, "%%%u: %s has type %s, expected %s", value,
+            IR_OPCODE_TO_STRING[opcode], IR_TYPE_TO_STRING[irType(function, value)], IR_TYPE_TO_STRING[resultType(opcode)]);
+        return false;
+    }
+
+    switch (opcode) {
+        case IR_OPCODE_CONSTANT: return true;
+        case IR_OPCODE_PARAMETER: {
+            if (verifier->BlockOf[value] != 0 || irFirst(function, value) >= function->Arity) {
+                snprintf(verifier->Message, verifier->Size, "%%%u: param %u is not a parameter of the entry block",
+                    value, irFirst(function, value));
+                return false;
+            }
+        } return true;
+        case IR_OPCODE_EXTEND: return checkOperand(verifier, value, irFirst(function, value), IR_TYPE_BOOL);
+        case IR_OPCODE_CALL: {
+            if (irSecond(function, value) >= bufferLength(function->Extra)
+                || irCallArity(function, value) > bufferLength(function->Extra) - irSecond(function, value) - 1) {
+                snprintf(verifier->Message, verifier->Size, "%%%u: call arguments are out of range", value);
+                return false;
+            }
+            for (uint32_t i = 0; i < irCallArity(function, value); i++) {
+                if (!checkOperand(verifier, value, irCallArguments(function, value)[i], IR_TYPE_INT)) return false;
+            }
+        } return true;
+        // Targets are checked along with the dominators.
+        case IR_OPCODE_JUMP: return true;
+        case IR_OPCODE_BRANCH: return checkOperand(verifier, value, irFirst(function, value), IR_TYPE_BOOL);
+        case IR_OPCODE_RETURN: {
+            return irFirst(function, value) == IR_NONE || checkOperand(verifier, value, irFirst(function, value), IR_TYPE_INT);
+        }
+        default: {
+            return checkOperand(verifier, value, irFirst(function, value), IR_TYPE_INT)
+                && checkOperand(verifier, value, irSecond(function, value), IR_TYPE_INT);
+        }
+    }
+}
+
+bool verifyIr(IrFunction* function, char* message, size_t size) {
+    uint32_t instructionCount = irInstructionCount(function);
+    uint32_t blockCount = bufferLength(function->Blocks) > 0 ? irBlockCount(function) : 0;
+    if (blockCount == 0 || irBlockStart(function, 0) != 0 || irBlockEnd(function, blockCount - 1) != instructionCount) {
+        snprintf(message, size, "blocks don't cover the instructions");
+        return false;
+    }
+
+    Verifier verifier = {
+        .Function = function,
+        .BlockOf = malloc(instructionCount * sizeof(IrBlock)),
+        .Dominators = malloc(blockCount * sizeof(IrBlock)),
+        .Message = message,
+        .Size = size,
+    };
+    bool valid = true;
+    for (IrBlock block = 0; block < blockCount && valid; block++) {
+        if (irBlockEnd(function, block) <= irBlockStart(function, block)) {
+            snprintf(message, size, "b%u is empty", block);
+            valid = false;
+        }
+        for (IrValue value = irBlockStart(function, block); value < irBlockEnd(function, block) && valid; value++) {
+            verifier.BlockOf[value] = block;
+            if (irOpcode(function, value) >= IR_OPCODE_COUNT) {
+                snprintf(message, size, "%%%u: unknown opcode %u", value, irOpcode(function, value));
+                valid = false;
+            } else if (isTerminator(irOpcode(function, value)) != (value + 1 == irBlockEnd(function, block))) {
+                snprintf(message, size, "%%%u: b%u must end in its only terminator", value, block);
+                valid = false;
+            }
+        }
+    }
+    valid = valid && findDominators(&verifier);
+    for (IrValue value = 0; value < instructionCount && valid; value++) {
+        valid = checkInstruction(&verifier, value);
+    }
+
+    free(verifier.BlockOf);
+    free(verifier.Dominators);
+    return valid;
+}
+
+static void dumpOperand(FILE* stream, IrValue value) {
+    fprintf(stream, "%%%u", value);
+}
+
+void dumpIr(FILE* stream, IrFunction* function) {
+    fprintf(stream, "function %s {\n", symbolName(function->Name));
+    for (IrBlock block = 0; block < irBlockCount(function); block++) {
+        fprintf(stream, "b%u:\n", block);
+        for (IrValue value = irBlockStart(function, block); value < irBlockEnd(function, block); value++) {
+            IrOpcode opcode = irOpcode(function, value);
+            fprintf(stream, "    ");
+            if (irType(function, value) != IR_TYPE_VOID) {
+                fprintf(stream, "%%%u: %s = ", value, IR_TYPE_TO_STRING[irType(function, value)]);
+            }
+            fprintf(stream, "%s", IR_OPCODE_TO_STRING[opcode]);
+            switch (opcode) {
+                case IR_OPCODE_CONSTANT: fprintf(stream, " %ld", (long)irConstant(function, value)); break;
+                case IR_OPCODE_PARAMETER: fprintf(stream, " %u", irFirst(function, value)); break;
+                case IR_OPCODE_EXTEND:
+                case IR_OPCODE_RETURN: {
+                    if (irFirst(function, value) != IR_NONE) {
+                        fprintf(stream, " ");
+                        dumpOperand(stream, irFirst(function, value));
+                    }
+                } break;
+                case IR_OPCODE_CALL: {
+                    fprintf(stream, " %s(", symbolName(irFirst(function, value)));
+                    for (uint32_t i = 0; i < irCallArity(function, value); i++) {
+                        fprintf(stream, "%s", i > 0 ? ", " : "");
+                        dumpOperand(stream, irCallArguments(function, value)[i]);
+                    }
+                    fprintf(stream, ")");
+                } break;
+                case IR_OPCODE_JUMP: fprintf(stream, " b%u", irFirst(function, value)); break;
+                case IR_OPCODE_BRANCH: {
+                    fprintf(stream, " ");
+                    dumpOperand(stream, irFirst(function, value));
+                    fprintf(stream, ", b%u, b%u", irBranchTarget(function, value, true), irBranchTarget(function, value, false));
+                } break;
+                default: {
+                    fprintf(stream, " ");
+                    dumpOperand(stream, irFirst(function, value));
+                    fprintf(stream, ", ");
+                    dumpOperand(stream, irSecond(function, value));
+                } break;
+            }
+            fprintf(stream, "\n");
+        }
+    }
+    fprintf(stream, "}\n");
+}
+
+void collectFunctions(Ast* ast, NodeIndex node, NodeIndex** functions) {
+    switch (nodeKind(ast, node)) {
+        case NODE_FUNCTION_DECLARATION: {
+            // Bodies that are still lazy were never reached from main.
+            if (nodeKind(ast, functionBlock(ast, node)) == NODE_LAZY_BLOCK) break;
+            bufferPush((*functions), node);
+            collectFunctions(ast, functionBlock(ast, node), functions);
+        } break;
+        case NODE_PROGRAM:
+        case NODE_BLOCK: {
+            for (uint32_t i = 0; i < blockCount(ast, node); i++) {
+                collectFunctions(ast, blockStatements(ast, node)[i], functions);
+            }
+        } break;
+        case NODE_IF: {
+            collectFunctions(ast, ifBlock(ast, node), functions);
+            collectFunctions(ast, ifElseBlock(ast, node), functions);
+        } break;
+        default: break;
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef IR_H
+#define IR_H
+
+#include "Common.h"
+#include "Node.h"
+#include "StretchyBuffer.h"
+#include <stdio.h>
+
+// Values are numbered by the instruction that defines them.
+typedef uint32_t IrValue;
+typedef uint32_t IrBlock;
+
+// Marks a missing value, such as the result of a return without one.
+#define IR_NONE UINT32_MAX
+
+#define IR_TYPES \
+        IR_TYPE(VOID, "void") \
+        IR_TYPE(BOOL, "bool") \
+        IR_TYPE(INT, "int") \
+
+typedef enum IrType {
+    #define IR_TYPE(t, _) IR_TYPE_##t,
+    IR_TYPES
+    #undef IR_TYPE
+} IrType;
+extern const char* IR_TYPE_TO_STRING[];
+
+// The comparisons are kept together, in the order of the Operations they are lowered from.
+#define IR_OPCODES \
+        IR_OPCODE(CONSTANT, "const") \
+        IR_OPCODE(PARAMETER, "param") \
+        IR_OPCODE(ADD, "add") \
+        IR_OPCODE(SUBTRACT, "sub") \
+        IR_OPCODE(MULTIPLY, "mul") \
+        IR_OPCODE(DIVIDE, "div") \
+        IR_OPCODE(GREATER, "gt") \
+        IR_OPCODE(GREATER_OR_EQUAL, "ge") \
+        IR_OPCODE(LESS, "lt") \
+        IR_OPCODE(LESS_OR_EQUAL, "le") \
+        IR_OPCODE(EQUAL, "eq") \
+        IR_OPCODE(NOT_EQUAL, "ne") \
+        IR_OPCODE(EXTEND, "extend") \
+        IR_OPCODE(CALL, "call") \
+        IR_OPCODE(JUMP, "jump") \
+        IR_OPCODE(BRANCH, "branch") \
+        IR_OPCODE(RETURN, "return") \
+
+typedef enum IrOpcode {
+    #define IR_OPCODE(o, _) IR_OPCODE_##o,
+    IR_OPCODES
+    #undef IR_OPCODE
+    IR_OPCODE_COUNT
+} IrOpcode;
+extern const char* IR_OPCODE_TO_STRING[];
+
+/*
+    One function in three-address form. Every value is defined by exactly one instruction, and Nash has neither
+    assignment nor loops, so the code is in SSA form without any phi instructions. Instructions are stored as
+    parallel arrays like the syntax tree, and each basic block is a run of them ending in its only terminator.
+    Branches only go forward, to blocks later in the function.
+
+    Opcode              Type        First               Second
+    CONSTANT            INT, BOOL   low 32 bits         high 32 bits
+    PARAMETER           INT         index
+    ADD ... DIVIDE      INT         left                right
+    GREATER ... EQUAL   BOOL        left                right
+    EXTEND              INT         BOOL operand
+    CALL                INT         Symbol              Extra: arity, arguments...
+    JUMP                VOID        block
+    BRANCH              VOID        BOOL condition      Extra: block if true, block if false
+    RETURN              VOID        value or IR_NONE
+
+    Blocks holds the first instruction of every block, followed by the instruction count.
+*/
+typedef struct IrFunction {
+    Symbol Name;
+    uint32_t Arity;
+    uint8_t* Opcodes;
+    uint8_t* Types;
+    uint32_t* First;
+    uint32_t* Second;
+    uint32_t* Extra;
+    uint32_t* Blocks;
+    // Variables in scope while lowering, innermost last, the arguments of the calls being lowered, and the new
+    // number of every value while unused ones are removed.
+    struct IrBinding* Bindings;
+    IrValue* Arguments;
+    IrValue* Renumbered;
+} IrFunction;
+
+typedef struct IrBinding {
+    Symbol Name;
+    IrValue Value;
+} IrBinding;
+
+IrFunction* newIrFunction(void);
+void freeIrFunction(IrFunction* function);
+
+/*
+    Replace the contents of `function` with the lowered body of a parsed function declaration. Variables that are
+    never declared and expressions the backend has no instructions for evaluate to 0, and statements after a return
+    are dropped. Operations on constants and identities such as x * 1 are folded as they are lowered, so constant
+    variables fold wherever they are used, and an if statement with a constant condition only lowers the branch
+    that runs. Values left unused by folding are removed.
+*/
+void lowerFunction(IrFunction* function, Ast* ast, NodeIndex declaration);
+
+/*
+    Check that every block ends in its only terminator, that branches go forward to existing blocks, that every
+    operand is defined by an instruction that dominates its use, and that operand types match.
+
+    Returns false and describes the first problem found in `message` if the function is malformed.
+*/
+bool verifyIr(IrFunction* function, char* message, size_t size);
+
+void dumpIr(FILE* stream, IrFunction* function);
+
+/*
+    Collect the function declarations to generate in declaration order: every top-level function whose body was
+    parsed, each followed by the functions nested in it. Appends them to `functions`, a stretchy buffer.
+*/
+void collectFunctions(Ast* ast, NodeIndex node, NodeIndex** functions);
+
+#define irInstructionCount(function) bufferLength((function)->Opcodes)
+#define irBlockCount(function) (bufferLength((function)->Blocks) - 1)
+#define irOpcode(function, value) ((IrOpcode)(function)->Opcodes[value])
+#define irType(function, value) ((IrType)(function)->Types[value])
+#define irFirst(function, value) ((function)->First[value])
+#define irSecond(function, value) ((function)->Second[value])
+#define irExtra(function, value) ((function)->Extra + (function)->Second[value])
+#define irConstant(function, value) ((int64_t)((uint64_t)(function)->First[value] | (uint64_t)(function)->Second[value] << 32))
+#define irCallArity(function, value) (irExtra(function, value)[0])
+#define irCallArguments(function, value) (irExtra(function, value) + 1)
+#define irBranchTarget(function, value, taken) (irExtra(function, value)[(taken) ? 0 : 1])
+#define irBlockStart(function, block) ((function)->Blocks[block])
+#define irBlockEnd(function, block) ((function)->Blocks[(block) + 1])
+#define irIsComparison(opcode) ((opcode) >= IR_OPCODE_GREATER && (opcode) <= IR_OPCODE_NOT_EQUAL)
+
+#endif
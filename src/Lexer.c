@@ -2,26 +2,40 @@
 #include "Common.h"
 #include "Token.h"
 #include "StretchyBuffer.h"
+#include "Symbol.h"
+#include "ScanKernels.h"
+#include "LineIndex.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
 
-Lexer* newLexer(const char* sourceFile) {
+Lexer* newLexer(const char* source, size_t length) {
     Lexer* lexer = calloc(1, sizeof(Lexer));
 
-    size_t sourceLength = strlen(sourceFile);
-    lexer->Source = strncpy(calloc(sourceLength + 1, sizeof(char)), sourceFile, sourceLength);
+    lexer->Source = source;
+    lexer->End = source + length;
     lexer->CurrentCharacter = lexer->Source;
-    lexer->Line = 1;
-    lexer->Column = 1;
-    lexer->Tokens = newStretchyBuffer(sizeof(Token));
+    // Sources rarely average fewer than three bytes per token. Untouched capacity of large arrays is never faulted in,
+    // so overestimating costs little.
+    lexer->Tokens = newTokenStream(source, length / 3);
+    lexer->Kernels = getScanKernels();
+    return lexer;
+}
+
+Lexer* newStreamingLexer(const char* source, size_t length, uint32_t capacity) {
+    Lexer* lexer = calloc(1, sizeof(Lexer));
+
+    lexer->Source = source;
+    lexer->End = source + length;
+    lexer->CurrentCharacter = lexer->Source;
+    lexer->Tokens = newTokenRing(source, capacity);
+    lexer->Kernels = getScanKernels();
     return lexer;
 }
 
 void freeLexer(Lexer* lexer) {
-    free(lexer->Source);
-    freeStretchyBuffer(lexer->Tokens);
+    freeTokenStream(lexer->Tokens);
+    free(lexer);
 }
 
 /*
@@ -29,30 +43,19 @@ void freeLexer(Lexer* lexer) {
 */
 static char advance(Lexer* lexer) {
     // TODO: consider adding proper bounds checking
-    char currentCharacter = *++lexer->CurrentCharacter;
-    
-    if (currentCharacter == '\n') {
-        lexer->Line++;
-        lexer->Column = 1;
-    } else {
-        lexer->Column++;
-    }
-    
-    return currentCharacter;
+    return *++lexer->CurrentCharacter;
 }
 
 /*
     Advance a given amount of steps and return the current character.
 */
 static char step(Lexer* lexer, unsigned int steps) {
-    while (steps-- > 0) {
-        advance(lexer);
-    }
+    lexer->CurrentCharacter += steps;
     return *lexer->CurrentCharacter;
 }
 
-static size_t getLexerIndex(Lexer* lexer) {
-    return lexer->CurrentCharacter - lexer->Source;
+static bool isAtEnd(Lexer* lexer) {
+    return lexer->CurrentCharacter >= lexer->End;
 }
 
 /*
@@ -76,148 +79,423 @@ static bool consume(Lexer* lexer, const char* lexeme) {
     return false;
 }
 
-static bool isIdentifier(char c) {
-    return isalnum(c) || c == '_';
+/*
+    Single-character punctuator starting with each character, or KIND_NONE.
+*/
+static const TokenKind PUNCTUATOR_START[256] = {
+    ['!'] = PUNCTUATOR_EXCLAMATION,
+    ['#'] = PUNCTUATOR_HASH,
+    ['$'] = PUNCTUATOR_DOLLAR,
+    ['%'] = PUNCTUATOR_PERCENT,
+    ['&'] = PUNCTUATOR_AMPERSAND,
+    ['\''] = PUNCTUATOR_APOSTROPHE,
+    ['('] = PUNCTUATOR_LEFT_PARENTHESIS,
+    [')'] = PUNCTUATOR_RIGHT_PARENTHESIS,
+    ['*'] = PUNCTUATOR_ASTERISK,
+    ['+'] = PUNCTUATOR_PLUS,
+    [','] = PUNCTUATOR_COMMA,
+    ['-'] = PUNCTUATOR_MINUS,
+    ['.'] = PUNCTUATOR_DOT,
+    ['/'] = PUNCTUATOR_SLASH,
+    [':'] = PUNCTUATOR_COLON,
+    [';'] = PUNCTUATOR_SEMICOLON,
+    ['<'] = PUNCTUATOR_LESS,
+    ['='] = PUNCTUATOR_EQUAL,
+    ['>'] = PUNCTUATOR_GREATER,
+    ['?'] = PUNCTUATOR_QUESTION,
+    ['@'] = PUNCTUATOR_AT,
+    ['['] = PUNCTUATOR_LEFT_BRACKET,
+    ['\\'] = PUNCTUATOR_BACKSLASH,
+    [']'] = PUNCTUATOR_RIGHT_BRACKET,
+    ['^'] = PUNCTUATOR_CARET,
+    ['_'] = PUNCTUATOR_UNDERSCORE,
+    ['`'] = PUNCTUATOR_BACKTICK,
+    ['{'] = PUNCTUATOR_LEFT_BRACE,
+    ['|'] = PUNCTUATOR_PIPE,
+    ['}'] = PUNCTUATOR_RIGHT_BRACE,
+    ['~'] = PUNCTUATOR_TILDE,
+};
+
+/*
+    Returns the punctuator formed by extending `punctuator` with the characters at `next`, or KIND_NONE when
+    it can't be extended. Together with PUNCTUATOR_START this is a DFA whose states are the punctuators themselves.
+*/
+static TokenKind extendPunctuator(TokenKind punctuator, const char* next) {
+    char c = *next;
+    switch (punctuator) {
+        case PUNCTUATOR_MINUS: return c == '>' ? PUNCTUATOR_ARROW : c == '-' ? PUNCTUATOR_MINUS_MINUS : c == '=' ? PUNCTUATOR_MINUS_EQUAL : KIND_NONE;
+        case PUNCTUATOR_PLUS: return c == '+' ? PUNCTUATOR_PLUS_PLUS : c == '=' ? PUNCTUATOR_PLUS_EQUAL : KIND_NONE;
+        case PUNCTUATOR_LESS: return c == '<' ? PUNCTUATOR_SHIFT_LEFT : c == '=' ? PUNCTUATOR_LESS_EQUAL : KIND_NONE;
+        case PUNCTUATOR_GREATER: return c == '>' ? PUNCTUATOR_SHIFT_RIGHT : c == '=' ? PUNCTUATOR_GREATER_EQUAL : KIND_NONE;
+        case PUNCTUATOR_AMPERSAND: return c == '&' ? PUNCTUATOR_LOGICAL_AND : c == '=' ? PUNCTUATOR_AMPERSAND_EQUAL : KIND_NONE;
+        case PUNCTUATOR_PIPE: return c == '|' ? PUNCTUATOR_LOGICAL_OR : c == '=' ? PUNCTUATOR_PIPE_EQUAL : KIND_NONE;
+        case PUNCTUATOR_SHIFT_LEFT: return c == '=' ? PUNCTUATOR_SHIFT_LEFT_EQUAL : KIND_NONE;
+        case PUNCTUATOR_SHIFT_RIGHT: return c == '=' ? PUNCTUATOR_SHIFT_RIGHT_EQUAL : KIND_NONE;
+        case PUNCTUATOR_EQUAL: return c == '=' ? PUNCTUATOR_EQUAL_EQUAL : KIND_NONE;
+        case PUNCTUATOR_EXCLAMATION: return c == '=' ? PUNCTUATOR_NOT_EQUAL : KIND_NONE;
+        case PUNCTUATOR_ASTERISK: return c == '=' ? PUNCTUATOR_ASTERISK_EQUAL : KIND_NONE;
+        case PUNCTUATOR_SLASH: return c == '=' ? PUNCTUATOR_SLASH_EQUAL : KIND_NONE;
+        case PUNCTUATOR_PERCENT: return c == '=' ? PUNCTUATOR_PERCENT_EQUAL : KIND_NONE;
+        case PUNCTUATOR_CARET: return c == '=' ? PUNCTUATOR_CARET_EQUAL : KIND_NONE;
+        // ".." isn't a punctuator, so look two characters ahead instead of adding a state for it.
+        case PUNCTUATOR_DOT: return c == '.' && next[1] == '.' ? PUNCTUATOR_ELLIPSIS : KIND_NONE;
+        default: return KIND_NONE;
+    }
+}
+
+/*
+    Returns the longest punctuator at the start of the lexeme, or KIND_NONE if it doesn't start with one.
+*/
+static TokenKind scanPunctuator(const char* lexeme) {
+    TokenKind punctuator = PUNCTUATOR_START[(uint8_t)*lexeme];
+    while (punctuator != KIND_NONE) {
+        TokenKind extended = extendPunctuator(punctuator, lexeme + TOKEN_KIND_LENGTH[punctuator]);
+        if (extended == KIND_NONE) break;
+        punctuator = extended;
+    }
+    return punctuator;
+}
+
+static TokenKind matchKeyword(const char* lexeme, size_t length, TokenKind keyword) {
+    return memcmp(lexeme, TOKEN_KIND_TO_STRING[keyword], length) == 0 ? keyword : KIND_NONE;
 }
 
 /*
-    Returns the length of the punctuator if it's a valid lexeme.
-    Returns 0 if the input lexeme is not a valid punctuator.
+    Returns the keyword spelled exactly by the lexeme, or KIND_NONE for an ordinary identifier.
+    Keywords are bucketed by length and then told apart by one or two characters, so at most one comparison is made.
 */
-static size_t isPunctuator(const char* lexeme) {
-    static const char* punctuators[] = {
-        "->", "++", "--", ">>", "<<", "<=", ">=", "==", "!=", "&&",
-        "||", "*=", "/=", "%=", "+=", "-=", "<<=", ">>=", "&=", "^=",
-        "|=", "..."
-    };
-    static const size_t punctuatorCount = sizeof(punctuators) / sizeof(*punctuators);
-    static const char** punctuatorsEnd = punctuators + punctuatorCount;
-
-    for (const char** punctuator = punctuators; punctuator != punctuatorsEnd; punctuator++) {
-        size_t punctuatorLength = strlen(*punctuator);
-        if (strneq(lexeme, *punctuator, punctuatorLength)) {
-            return punctuatorLength;
+static TokenKind lookupKeyword(const char* lexeme, size_t length) {
+    #define MATCH(k) return matchKeyword(lexeme, length, KEYWORD_##k)
+
+    switch (length) {
+        case 2: switch (lexeme[0]) {
+            case 'a': MATCH(AS);
+            case 'd': MATCH(DO);
+            case 'i': MATCH(IF);
+        } break;
+        case 3: switch (lexeme[0]) {
+            case 'a': MATCH(ANY);
+            case 'f': MATCH(FOR);
+            case 'i': MATCH(INT);
+            case 'l': MATCH(LET);
+        } break;
+        case 4: switch (lexeme[0]) {
+            case 'b': MATCH(BOOL);
+            case 'c': return lexeme[1] == 'a' ? matchKeyword(lexeme, length, KEYWORD_CASE) : matchKeyword(lexeme, length, KEYWORD_CHAR);
+            case 'e': return lexeme[1] == 'l' ? matchKeyword(lexeme, length, KEYWORD_ELSE) : matchKeyword(lexeme, length, KEYWORD_ENUM);
+            case 'g': MATCH(GOTO);
+            case 'n': MATCH(NULL);
+            case 't': return lexeme[1] == 'h' ? matchKeyword(lexeme, length, KEYWORD_THIS) : matchKeyword(lexeme, length, KEYWORD_TRUE);
+            case 'v': MATCH(VOID);
+        } break;
+        case 5: switch (lexeme[0]) {
+            case 'b': MATCH(BREAK);
+            case 'c': return lexeme[1] == 'l' ? matchKeyword(lexeme, length, KEYWORD_CLASS) : matchKeyword(lexeme, length, KEYWORD_CONST);
+            case 'f': return lexeme[1] == 'a' ? matchKeyword(lexeme, length, KEYWORD_FALSE) : matchKeyword(lexeme, length, KEYWORD_FLOAT);
+            case 's': MATCH(SHORT);
+            case 'u': MATCH(UNION);
+            case 'w': MATCH(WHILE);
+        } break;
+        case 6: switch (lexeme[0]) {
+            case 'd': MATCH(DOUBLE);
+            case 'i': return lexeme[2] == 'p' ? matchKeyword(lexeme, length, KEYWORD_IMPORT) : matchKeyword(lexeme, length, KEYWORD_INLINE);
+            case 'p': MATCH(PUBLIC);
+            case 'r': MATCH(RETURN);
+            case 's': switch (lexeme[1]) {
+                case 'i': return lexeme[2] == 'g' ? matchKeyword(lexeme, length, KEYWORD_SIGNED) : matchKeyword(lexeme, length, KEYWORD_SIZEOF);
+                case 't': switch (lexeme[3]) {
+                    case 't': MATCH(STATIC);
+                    case 'i': MATCH(STRING);
+                    case 'u': MATCH(STRUCT);
+                } break;
+                case 'w': MATCH(SWITCH);
+            } break;
+            case 't': MATCH(TYPEOF);
+        } break;
+        case 7: switch (lexeme[0]) {
+            case 'd': MATCH(DEFAULT);
+            case 'p': MATCH(PRIVATE);
+        } break;
+        case 8: switch (lexeme[0]) {
+            case 'c': MATCH(CONTINUE);
+            case 'f': MATCH(FUNCTION);
+            case 'u': MATCH(UNSIGNED);
+        } break;
+        case 9: switch (lexeme[0]) {
+            case 'n': MATCH(NAMESPACE);
+            case 'p': MATCH(PROTECTED);
+        } break;
+    }
+
+    #undef MATCH
+    return KIND_NONE;
+}
+
+/*
+    Length of a string literal's contents without its quotes. An unterminated string has no closing quote.
+*/
+static size_t stringContentLength(const char* lexeme, size_t length) {
+    return length - (length > 1 && lexeme[length - 1] == '"' ? 2 : 1);
+}
+
+static uint32_t symbolValue(Lexer* lexer, const char* name, size_t length) {
+    return lexer->DeferInterning ? hashSymbolName(name, length) : intern(name, length);
+}
+
+/*
+    Lex the next token into the lexer's stream, or the EOF token once the source is exhausted.
+*/
+static void lexToken(Lexer* lexer) {
+    TokenStream* tokens = lexer->Tokens;
+    const ScanKernels* kernels = lexer->Kernels;
+    if (isSpaceCharacter(*lexer->CurrentCharacter)) {
+        lexer->CurrentCharacter = kernels->SkipWhitespace(lexer->CurrentCharacter + 1);
+    }
+    if (isAtEnd(lexer)) {
+        pushToken(tokens, KIND_EOF, lexer->End - lexer->Source, 1, 0);
+        lexer->Finished = true;
+        return;
+    }
+
+    const char* current = lexer->CurrentCharacter;
+    char currentCharacter = *current;
+    TokenKind kind = KIND_NONE;
+    uint32_t value = 0;
+
+    if (isAlphaCharacter(currentCharacter)) {
+        lexer->CurrentCharacter = kernels->SkipIdentifier(current + 1);
+        kind = lookupKeyword(current, lexer->CurrentCharacter - current);
+        if (kind == KIND_NONE) {
+            kind = KIND_IDENTIFIER;
+            value = symbolValue(lexer, current, lexer->CurrentCharacter - current);
+        }
+    } else if (isDigitCharacter(currentCharacter) || (currentCharacter == '.' && isDigitCharacter(peek(lexer)))) {
+        // TODO: convert integer to an actual number
+        kind = KIND_INTEGER;
+        int base = 10;
+        double number = 0;
+
+        const char* digitsEnd = kernels->SkipDigits(current);
+        for (const char* digit = current; digit != digitsEnd; digit++) {
+            number = (*digit - '0') + number * base;
+        }
+        lexer->CurrentCharacter = digitsEnd;
+
+        if (consume(lexer, ".")) {
+            kind = KIND_REAL;
+            lexer->CurrentCharacter = kernels->SkipDigits(lexer->CurrentCharacter);
+        }
+
+        if (consume(lexer, "e") || consume(lexer, "E")) {
+            kind = KIND_REAL;
+            if (!consume(lexer, "-")) consume(lexer, "+");
+            lexer->CurrentCharacter = kernels->SkipDigits(lexer->CurrentCharacter);
         }
+
+        uint64_t bits = (uint64_t)(int)number;
+        if (kind == KIND_REAL) {
+            memcpy(&bits, &number, sizeof(bits));
+        }
+        value = pushLiteral(tokens, bits);
+    } else if (consume(lexer, "\"")) {
+        kind = KIND_STRING;
+        lexer->CurrentCharacter = kernels->FindByte(lexer->CurrentCharacter, lexer->End, '"');
+        // TODO: make sure the string was closed correctly
+        consume(lexer, "\"");
+
+        value = symbolValue(lexer, current + 1, stringContentLength(current, lexer->CurrentCharacter - current));
+    } else if ((kind = scanPunctuator(current)) != KIND_NONE) {
+        lexer->CurrentCharacter = current + TOKEN_KIND_LENGTH[kind];
+    } else {
+        advance(lexer);
+    }
+
+    pushToken(tokens, kind, current - lexer->Source, lexer->CurrentCharacter - current, value);
+}
+
+TokenStream* scanTokens(Lexer* lexer) {
+    while (!lexer->Finished) {
+        lexToken(lexer);
     }
+    return lexer->Tokens;
+}
 
-    return ispunct(*lexeme) ? 1 : 0;
+void pullTokens(Lexer* lexer, uint32_t count) {
+    while (count-- > 0 && !lexer->Finished) {
+        lexToken(lexer);
+    }
 }
 
-static bool isKeyword(const char* lexeme, size_t lexemeLength) {
-    static const char* keywords[] = {
-        "any", "as", "bool", "break", "case", "char", "class", "const", "continue", "default", "do", "double", "else",
-        "enum", "false", "float", "for", "function", "goto", "if", "import", "inline", "int", "let", "namespace",
-        "null", "private", "protected", "public", "return", "short", "signed", "sizeof", "static", "string", "struct",
-        "switch", "this", "true", "typeof", "union", "unsigned", "void", "while"
-    };
-    static const size_t keywordCount = sizeof(keywords) / sizeof(*keywords);
-    static const char** keywordsEnd = keywords + keywordCount;
+// Chunks smaller than this aren't worth handing to another thread.
+#define PARALLEL_CHUNK_MINIMUM (256 * 1024)
 
-    for (const char** keyword = keywords; keyword != keywordsEnd; keyword++) {
-        size_t keywordLength = strlen(*keyword);
-        if (strneq(lexeme, *keyword, keywordLength)) {
-            return true;
+typedef struct LexChunk {
+    Lexer* Lexer;
+    TokenStream* Output;
+    TokenIndex FirstToken;
+    uint32_t FirstLiteral;
+    // Drop the chunk's EOF token; only the last chunk keeps it.
+    bool DropEof;
+} LexChunk;
+
+/*
+    Quote parity carried across boundary searches. Strings have no escapes, so a position is inside a string exactly
+    when an odd number of quotes precede it.
+*/
+typedef struct QuoteScan {
+    const char* NextQuote;
+    bool InString;
+} QuoteScan;
+
+/*
+    Find the first position after a newline at or past `target` that lies outside string literals, or the end of
+    the source. Targets must be passed in increasing order.
+*/
+static const char* findChunkBoundary(Lexer* lexer, QuoteScan* scan, const char* target) {
+    const ScanKernels* kernels = lexer->Kernels;
+    const char* end = lexer->End;
+    const char* candidate = target;
+    while (true) {
+        while (scan->NextQuote < candidate) {
+            scan->InString = !scan->InString;
+            scan->NextQuote = kernels->FindByte(scan->NextQuote + 1, end, '"');
         }
+
+        if (!scan->InString) {
+            const char* newline = kernels->FindByte(candidate, scan->NextQuote, '\n');
+            if (newline != scan->NextQuote) return newline + 1;
+        }
+
+        // Either inside a string or a string starts before the next newline: continue after that quote.
+        if (scan->NextQuote == end) return end;
+        candidate = scan->NextQuote + 1;
     }
+}
 
-    return false;
+/*
+    Create a lexer over [start, end) of another lexer's source. Offsets stay relative to the whole source.
+*/
+static Lexer* newChunkLexer(Lexer* lexer, const char* start, const char* end) {
+    Lexer* chunkLexer = calloc(1, sizeof(Lexer));
+
+    chunkLexer->Source = lexer->Source;
+    chunkLexer->End = end;
+    chunkLexer->CurrentCharacter = start;
+    chunkLexer->Tokens = newTokenStream(lexer->Source, (end - start) / 3);
+    chunkLexer->Kernels = lexer->Kernels;
+    chunkLexer->DeferInterning = true;
+    return chunkLexer;
 }
 
-Token* scanTokens(Lexer* lexer) {
-    if (bufferLength(lexer->Tokens) > 0) {
-        return lexer->Tokens;
+static void lexChunk(void* argument) {
+    LexChunk* chunk = argument;
+    scanTokens(chunk->Lexer);
+}
+
+static void copyChunk(void* argument) {
+    LexChunk* chunk = argument;
+    TokenStream* tokens = chunk->Lexer->Tokens;
+    TokenStream* output = chunk->Output;
+    uint32_t count = tokens->Count - chunk->DropEof;
+    TokenIndex first = chunk->FirstToken;
+
+    memcpy(output->Kinds + first, tokens->Kinds, count * sizeof(uint8_t));
+    memcpy(output->Offsets + first, tokens->Offsets, count * sizeof(uint32_t));
+    memcpy(output->Lengths + first, tokens->Lengths, count * sizeof(uint32_t));
+    memcpy(output->Literals + chunk->FirstLiteral, tokens->Literals, tokens->LiteralCount * sizeof(uint64_t));
+    for (TokenIndex token = 0; token < count; token++) {
+        uint32_t value = tokens->Values[token];
+        TokenKind kind = tokens->Kinds[token];
+        if (kind == KIND_INTEGER || kind == KIND_REAL) {
+            value += chunk->FirstLiteral;
+        }
+        output->Values[first + token] = value;
+    }
+}
+
+TokenStream* scanTokensParallel(Lexer* lexer, ThreadPool* pool) {
+    size_t length = lexer->End - lexer->Source;
+    uint32_t chunkCount = pool->ThreadCount;
+    if (length / PARALLEL_CHUNK_MINIMUM < chunkCount) {
+        chunkCount = length / PARALLEL_CHUNK_MINIMUM;
+    }
+    if (chunkCount < 2 || lexer->Finished || isTokenRing(lexer->Tokens)) {
+        return scanTokens(lexer);
     }
 
-    char currentCharacter = *lexer->CurrentCharacter;
-    while (currentCharacter) {
-        currentCharacter = *lexer->CurrentCharacter;
-        if (isspace(currentCharacter)) {
-            do {
-                currentCharacter = advance(lexer);
-            } while (isspace(currentCharacter));
-            continue;
+    LexChunk* chunks = calloc(chunkCount, sizeof(LexChunk));
+    QuoteScan scan = { .NextQuote = lexer->Kernels->FindByte(lexer->Source, lexer->End, '"'), .InString = false };
+    const char* start = lexer->Source;
+    uint32_t usedChunks = 0;
+    for (uint32_t i = 0; i < chunkCount && start < lexer->End; i++) {
+        const char* end = lexer->End;
+        if (i + 1 < chunkCount) {
+            const char* target = lexer->Source + length / chunkCount * (i + 1);
+            end = findChunkBoundary(lexer, &scan, target > start ? target : start);
         }
 
-        size_t start = getLexerIndex(lexer);
-        Token token = createToken(TOKEN_UNKNOWN, lexer->CurrentCharacter, 1, lexer->Line, lexer->Column);
-        
-        if (isalpha(currentCharacter)) {
-            token.Type = TOKEN_IDENTIFIER;
-            do {
-                currentCharacter = advance(lexer);
-            } while (isIdentifier(currentCharacter));
-            token.Length = getLexerIndex(lexer) - start;
-            token.Name = strndup(token.Lexeme, token.Length);
-
-            if (isKeyword(token.Lexeme, token.Length)) {
-                token.Type = TOKEN_KEYWORD;
-            }
-        } else if (isdigit(currentCharacter) || (currentCharacter == '.' && isdigit(peek(lexer)))) {
-            // TODO: convert integer to an actual number
-            token.Type = TOKEN_INTEGER;
-            int base = 10;
-            double value = 0;
-
-            while (isdigit(currentCharacter)) {
-                int digit = currentCharacter - '0';
-                value = digit + value * base;
-                currentCharacter = advance(lexer);
-            }
-
-            if (consume(lexer, ".")) {
-                token.Type = TOKEN_REAL;
-                do {
-                    currentCharacter = advance(lexer);
-                } while (isdigit(currentCharacter));
-            }
-            
-            if (consume(lexer, "e") || consume(lexer, "E")) {
-                token.Type = TOKEN_REAL;
-                consume(lexer, "-") || consume(lexer, "+");
-                do {
-                    currentCharacter = advance(lexer);
-                } while (isdigit(currentCharacter));
-            }
-
-            if (token.Type == TOKEN_INTEGER) {
-                token.Integer = (int)value;
-            } else {
-                token.Real = value;
-            }
-
-            token.Length = getLexerIndex(lexer) - start;
-        } else if (consume(lexer, "\"")) {
-            token.Type = TOKEN_STRING;
-            do {
-                currentCharacter = advance(lexer);
-            } while (!consume(lexer, "\"") && currentCharacter);
-            // TODO: make sure the string was closed correctly
-
-            token.Length = getLexerIndex(lexer) - start;
-        } else if (ispunct(currentCharacter)) {
-            token.Type = TOKEN_PUNCTUATOR;
-            token.Length = isPunctuator(token.Lexeme);
-            step(lexer, token.Length);
-        } else {
-            if (currentCharacter == '\0') break;
-            advance(lexer);
+        chunks[usedChunks++] = (LexChunk) { .Lexer = newChunkLexer(lexer, start, end), .Output = lexer->Tokens, .DropEof = true };
+        start = end;
+    }
+    chunks[usedChunks - 1].DropEof = false;
+
+    for (uint32_t i = 0; i < usedChunks; i++) {
+        submitTask(pool, lexChunk, &chunks[i]);
+    }
+    waitForTasks(pool);
+
+    uint32_t tokenCount = 0;
+    uint32_t literalCount = 0;
+    for (uint32_t i = 0; i < usedChunks; i++) {
+        chunks[i].FirstToken = tokenCount;
+        chunks[i].FirstLiteral = literalCount;
+        tokenCount += chunks[i].Lexer->Tokens->Count - chunks[i].DropEof;
+        literalCount += chunks[i].Lexer->Tokens->LiteralCount;
+    }
+
+    TokenStream* tokens = lexer->Tokens;
+    reserveTokenStream(tokens, tokenCount, literalCount);
+    for (uint32_t i = 0; i < usedChunks; i++) {
+        submitTask(pool, copyChunk, &chunks[i]);
+    }
+    waitForTasks(pool);
+    tokens->Count = tokenCount;
+    tokens->LiteralCount = literalCount;
+
+    // Intern in source order so every symbol gets the same number as with the serial lexer.
+    for (TokenIndex token = 0; token < tokenCount; token++) {
+        TokenKind kind = tokens->Kinds[token];
+        if (kind == KIND_IDENTIFIER) {
+            tokens->Values[token] = internHashed(tokenLexeme(tokens, token), tokens->Lengths[token], tokens->Values[token]);
+        } else if (kind == KIND_STRING) {
+            const char* lexeme = tokenLexeme(tokens, token);
+            size_t contentLength = stringContentLength(lexeme, tokens->Lengths[token]);
+            tokens->Values[token] = internHashed(lexeme + 1, contentLength, tokens->Values[token]);
         }
+    }
 
-        bufferPush(lexer->Tokens, token);
+    for (uint32_t i = 0; i < usedChunks; i++) {
+        freeLexer(chunks[i].Lexer);
     }
+    free(chunks);
 
-    Token eof = createToken(TOKEN_EOF, lexer->CurrentCharacter, 1, lexer->Line, lexer->Column);
-    bufferPush(lexer->Tokens, eof);
-    return lexer->Tokens;
+    lexer->CurrentCharacter = lexer->End;
+    lexer->Finished = true;
+    return tokens;
 }
 
 void printTokens(Lexer* lexer) {
-    Token* tokens = scanTokens(lexer);
-    for (Token* token = tokens; token != bufferEnd(tokens); token++) {
-        printf("%s%s", TOKEN_TO_STRING[token->Type], token->Type != TOKEN_EOF ? ", " : "\0");
-        if (token->Type != TOKEN_EOF) {
-            printf("`%.*s`", (int)token->Length, token->Lexeme);
+    TokenStream* tokens = scanTokens(lexer);
+    LineIndex* lines = newLineIndex(lexer->Source, lexer->End - lexer->Source);
+    for (TokenIndex token = 0; token < tokens->Count; token++) {
+        SourceLocation location = resolveLocation(lines, tokenOffset(tokens, token));
+        TokenType type = tokenType(tokens, token);
+        printf("%u:%u: ", location.Line, location.Column);
+        printf("%s%s", TOKEN_TO_STRING[type], type != TOKEN_EOF ? ", " : "\0");
+        if (type != TOKEN_EOF) {
+            printf("`%.*s`", (int)tokenLength(tokens, token), tokenLexeme(tokens, token));
         }
         printf("\n");
     }
-}
\ No newline at end of file
+    freeLineIndex(lines);
+}
@@ -3,18 +3,52 @@
 
 #include "Common.h"
 #include "Token.h"
+#include "ScanKernels.h"
+#include "ThreadPool.h"
 
 typedef struct Lexer {
-    char* Source;
+    const char* Source;
+    const char* End;
     const char* CurrentCharacter;
-    Token* Tokens;
-    int Line, Column;
+    TokenStream* Tokens;
+    const ScanKernels* Kernels;
+    // Set once the EOF token has been pushed.
+    bool Finished;
+    // Store the name hash instead of the symbol for identifiers and strings, so chunks can be lexed in parallel
+    // and interned afterwards in source order.
+    bool DeferInterning;
 } Lexer;
 
-Lexer* newLexer(const char* sourceFile);
+/*
+    Create a lexer over `length` bytes of source. The source isn't copied: it must stay alive for as long as the
+    tokens are in use, and `source[length]` must be readable (a '\0' sentinel, as SourceBuffer provides).
+*/
+Lexer* newLexer(const char* source, size_t length);
+
+/*
+    Create a lexer that produces tokens on demand into a ring of at least `capacity` tokens, so token memory stays
+    bounded regardless of the source size. Tokens are pulled with pullTokens.
+*/
+Lexer* newStreamingLexer(const char* source, size_t length, uint32_t capacity);
 void freeLexer(Lexer* lexer);
 
-Token* scanTokens(Lexer* lexer);
+/*
+    Lex the whole source and return all of its tokens, ending with EOF.
+*/
+TokenStream* scanTokens(Lexer* lexer);
+
+/*
+    Lex the whole source like scanTokens, split into one chunk per worker of `pool`. Chunks end after newlines outside
+    string literals, which always fall between tokens. The chunks' tokens are stitched back together and interned in
+    source order, so the result is identical to scanTokens. Small sources are lexed serially.
+*/
+TokenStream* scanTokensParallel(Lexer* lexer, ThreadPool* pool);
+
+/*
+    Lex up to `count` more tokens, stopping after EOF. On a streaming lexer, pulling overwrites the oldest tokens of
+    the ring.
+*/
+void pullTokens(Lexer* lexer, uint32_t count);
 void printTokens(Lexer* lexer);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "LineIndex.h"
+#include "ScanKernels.h"
+#include "StretchyBuffer.h"
+#include <stdlib.h>
+
+LineIndex* newLineIndex(const char* source, size_t length) {
+    LineIndex* index = calloc(1, sizeof(LineIndex));
+
+    const ScanKernels* kernels = getScanKernels();
+    const char* end = source + length;
+    uint32_t* lineStarts = newStretchyBuffer(sizeof(uint32_t));
+    bufferPush(lineStarts, 0);
+    for (const char* newline = kernels->FindByte(source, end, '\n'); newline != end; newline = kernels->FindByte(newline + 1, end, '\n')) {
+        bufferPush(lineStarts, newline + 1 - source);
+    }
+
+    index->LineStarts = lineStarts;
+    index->LineCount = bufferLength(lineStarts);
+    return index;
+}
+
+void freeLineIndex(LineIndex* index) {
+    if (!index) return;
+    freeStretchyBuffer(index->LineStarts);
+    free(index);
+}
+
+SourceLocation resolveLocation(LineIndex* index, uint32_t offset) {
+    // Find the last line that starts at or before the offset.
+    uint32_t low = 0;
+    uint32_t high = index->LineCount;
+    while (high - low > 1) {
+        uint32_t middle = low + (high - low) / 2;
+        if (index->LineStarts[middle] <= offset) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    return (SourceLocation) {
+        .Line = low + 1,
+        .Column = offset - index->LineStarts[low] + 1
+    };
+}
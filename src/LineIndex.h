@@ -0,0 +1,30 @@
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include "Common.h"
+
+typedef struct SourceLocation {
+    uint32_t Line, Column;
+} SourceLocation;
+
+/*
+    Byte offsets at which each line of a source starts. Tokens only record their offset; lines and columns are
+    resolved through this index when a diagnostic or debug output actually needs them.
+*/
+typedef struct LineIndex {
+    uint32_t* LineStarts;
+    uint32_t LineCount;
+} LineIndex;
+
+/*
+    Build the line index of `length` bytes of source. `source[length]` must be readable, as for the lexer.
+*/
+LineIndex* newLineIndex(const char* source, size_t length);
+void freeLineIndex(LineIndex* index);
+
+/*
+    Resolve a byte offset to its 1-based line and column.
+*/
+SourceLocation resolveLocation(LineIndex* index, uint32_t offset);
+
+#endif
@@ -1,41 +1,9 @@
 #include "Node.h"
-#include "StretchyBuffer.h"
 #include <stdio.h>
 #include <stdlib.h>
 
-static Node* newNode(NodeType type) {
-    Node* node = calloc(1, sizeof(Node));
-    node->Type = type;
-    return node;
-}
-
-Node* newExpressionNode(Expression* expression) {
-    Node* node = newNode(NODE_EXPRESSION);
-    node->Expression = expression;
-    return node;
-}
-Node* newDeclarationNode(Declaration* declaration) {
-    Node* node = newNode(NODE_DECLARATION);
-    node->Declaration = declaration;
-    return node;
-}
-Node* newStatementNode(Statement* statement) {
-    Node* node = newNode(NODE_STATEMENT);
-    node->Statement = statement;
-    return node;
-}
-
-Node* newProgramNode() {
-    Node* node = newNode(NODE_PROGRAM);
-    node->Program = calloc(1, sizeof(ProgramNode));
-    node->Program->Count = 0;
-    node->Program->Nodes = newStretchyBuffer(sizeof(Node*));
-    return node;
-}
-
-void addNode(ProgramNode* program, Node* node) {
-    program->Count += 1;
-    bufferPush(program->Nodes, node);
+NodeIndex newProgramNode(Ast* ast, const NodeIndex* statements, uint32_t count) {
+    return addNode(ast, NODE_PROGRAM, addExtra(ast, statements, count), count);
 }
 
 static void printIndentation(FILE* stream, unsigned int indentation) {
@@ -44,45 +12,48 @@ static void printIndentation(FILE* stream, unsigned int indentation) {
     }
 }
 
-void dumpExpression(FILE* stream, Expression* expression, unsigned int indentation) {
-    switch (expression->Type) {
-        case EXPRESSION_LITERAL: {
+void dumpExpression(FILE* stream, Ast* ast, NodeIndex expression, unsigned int indentation) {
+    switch (nodeKind(ast, expression)) {
+        case NODE_INTEGER_LITERAL: {
             printIndentation(stream, indentation);
-            Literal literal = expression->Literal;
-            switch (literal.Type) {
-                case LITERAL_INTEGER: fprintf(stream, "%lu", literal.Integer); break;
-                case LITERAL_FLOAT: fprintf(stream, "%g", literal.Float); break;
-            }
+            fprintf(stream, "%lu", literalInteger(ast, expression));
+        } break;
+        case NODE_FLOAT_LITERAL: {
+            printIndentation(stream, indentation);
+            fprintf(stream, "%g", literalFloat(ast, expression));
         } break;
-        case EXPRESSION_BINARY: {
-            BinaryExpression binary = expression->Binary;
+        case NODE_STRING_LITERAL: {
+            printIndentation(stream, indentation);
+            fprintf(stream, "\"%s\"", symbolName(nodeFirst(ast, expression)));
+        } break;
+        case NODE_BINARY: {
             printIndentation(stream, indentation);
             fprintf(stream, "{\n");
             printIndentation(stream, indentation + 1);
-            fprintf(stream, "\"Operation\": \"%s\",\n", OPERATION_TO_STRING[binary.Operation]);
+            fprintf(stream, "\"Operation\": \"%s\",\n", OPERATION_TO_STRING[nodeOperation(ast, expression)]);
             printIndentation(stream, indentation + 1);
             fprintf(stream, "\"Left\": ");
-            dumpExpression(stream, binary.Left, indentation + 1);
+            dumpExpression(stream, ast, nodeFirst(ast, expression), indentation + 1);
             fprintf(stdout, ",\n");
             printIndentation(stream, indentation + 1);
             fprintf(stream, "\"Right\": ");
-            dumpExpression(stream, binary.Right, indentation + 1);
+            dumpExpression(stream, ast, nodeSecond(ast, expression), indentation + 1);
             fprintf(stdout, "\n");
             printIndentation(stream, indentation);
             fprintf(stream, "}");
         } break;
-        case EXPRESSION_CALL: {
-            FunctionCall call = expression->Call;
+        case NODE_CALL: {
+            uint32_t arity = callArity(ast, expression);
             printIndentation(stream, indentation);
             fprintf(stream, "{\n");
             printIndentation(stream, indentation + 1);
-            fprintf(stream, "\"Name\": \"%s\",\n", call.Name);
+            fprintf(stream, "\"Name\": \"%s\",\n", symbolName(nodeFirst(ast, expression)));
             printIndentation(stream, indentation + 1);
-            fprintf(stream, "\"Arguments\": [%s", call.Arity > 0 ? "\n" : "\0");
-            for (size_t i = 0; i < call.Arity; i++) {
-                Expression* argument = call.Arguments[i];
-                dumpExpression(stream, argument, indentation + 2);
-                fprintf(stream, "%s", i + 1 < call.Arity ? ",\n" : "\0");
+            fprintf(stream, "\"Arguments\": [%s", arity > 0 ? "\n" : "\0");
+            for (uint32_t i = 0; i < arity; i++) {
+                NodeIndex argument = callArguments(ast, expression)[i];
+                dumpExpression(stream, ast, argument, indentation + 2);
+                fprintf(stream, "%s", i + 1 < arity ? ",\n" : "\0");
             }
             fprintf(stream, "\n");
             printIndentation(stdout, indentation + 1);
@@ -90,44 +61,44 @@ void dumpExpression(FILE* stream, Expression* expression, unsigned int indentati
             printIndentation(stream, indentation);
             fprintf(stream, "}");
         } break;
-        case EXPRESSION_VARIABLE: {
-            Expression* variable = expression;
+        case NODE_VARIABLE: {
             printIndentation(stream, indentation);
-            fprintf(stream, "\"%s\"", variable->Variable);
+            fprintf(stream, "\"%s\"", symbolName(nodeFirst(ast, expression)));
         } break;
+        default: break;
     }
 }
 
-void dumpDeclaration(FILE* stream, Declaration* declaration, unsigned int indentation) {
-    switch (declaration->Type) {
-        case DECLARATION_VARIABLE: {
-            VariableDeclaration variableDeclaration = declaration->Variable;
+void dumpDeclaration(FILE* stream, Ast* ast, NodeIndex declaration, unsigned int indentation) {
+    switch (nodeKind(ast, declaration)) {
+        case NODE_VARIABLE_DECLARATION: {
+            NodeIndex initializer = nodeSecond(ast, declaration);
             printIndentation(stream, indentation);
             fprintf(stream, "\"VariableDeclaration\": {\n");
             printIndentation(stream, indentation + 1);
-            fprintf(stream, "\"Name\": \"%s\"%s\n", declaration->Name, variableDeclaration.Initializer ? "," : "\0");
-            if (variableDeclaration.Initializer) {
+            fprintf(stream, "\"Name\": \"%s\"%s\n", symbolName(nodeFirst(ast, declaration)), initializer ? "," : "\0");
+            if (initializer) {
                 printIndentation(stream, indentation + 1);
                 fprintf(stream, "\"Value\": ");
-                dumpExpression(stream, variableDeclaration.Initializer, indentation + 1);
+                dumpExpression(stream, ast, initializer, indentation + 1);
                 fprintf(stream, "\n");
             }
             printIndentation(stream, indentation);
             fprintf(stream, "}");
         } break;
-        case DECLARATION_FUNCTION: {
-            FunctionDeclaration functionDeclaration = declaration->Function;
+        case NODE_FUNCTION_DECLARATION: {
+            uint32_t arity = functionArity(ast, declaration);
             printIndentation(stream, indentation);
             fprintf(stream, "\"FunctionDeclaration\": {\n");
             printIndentation(stream, indentation + 1);
-            fprintf(stream, "\"Name\": \"%s\",\n", declaration->Name);
+            fprintf(stream, "\"Name\": \"%s\",\n", symbolName(nodeFirst(ast, declaration)));
             printIndentation(stream, indentation + 1);
             fprintf(stream, "\"Parameters\": [");
-            if (functionDeclaration.Arity > 0) {
+            if (arity > 0) {
                 fprintf(stream, "\n");
-                for (size_t i = 0; i < functionDeclaration.Arity; i++) {
-                    Declaration* parameter = functionDeclaration.Parameters[i];
-                    dumpDeclaration(stream, parameter, indentation + 2);
+                for (uint32_t i = 0; i < arity; i++) {
+                    NodeIndex parameter = functionParameters(ast, declaration)[i];
+                    dumpDeclaration(stream, ast, parameter, indentation + 2);
                 }
                 fprintf(stream, "\n");
                 printIndentation(stream, indentation + 1);
@@ -135,78 +106,77 @@ void dumpDeclaration(FILE* stream, Declaration* declaration, unsigned int indent
             fprintf(stream, "],\n");
             printIndentation(stream, indentation + 1);
             fprintf(stream, "\"Block\": ");
-            dumpStatement(stream, functionDeclaration.Block, indentation + 1);
+            dumpStatement(stream, ast, functionBlock(ast, declaration), indentation + 1);
             printf("\n");
             printIndentation(stream, indentation);
             fprintf(stream, "}");
-        }
+        } break;
+        default: break;
     }
 }
 
-void dumpStatement(FILE* stream, Statement* statement, unsigned int indentation) {
-    switch (statement->Type) {
-        case STATEMENT_EXPRESSION: dumpExpression(stream, statement->Expresssion, indentation); break;
-        case STATEMENT_DECLARATION: dumpDeclaration(stream, statement->Declaration, indentation); break;
-        case STATEMENT_BLOCK: {
-            StatementBlock* block = statement->Block;
+void dumpStatement(FILE* stream, Ast* ast, NodeIndex statement, unsigned int indentation) {
+    switch (nodeKind(ast, statement)) {
+        case NODE_EXPRESSION_STATEMENT: dumpExpression(stream, ast, nodeFirst(ast, statement), indentation); break;
+        case NODE_VARIABLE_DECLARATION:
+        case NODE_FUNCTION_DECLARATION: dumpDeclaration(stream, ast, statement, indentation); break;
+        case NODE_BLOCK: {
+            uint32_t count = blockCount(ast, statement);
             fprintf(stream, "[");
-            if (block->Count > 0) {
+            if (count > 0) {
                 fprintf(stream, "\n");
-                for (size_t i = 0; i < block->Count; i++) {
-                    Statement* statement = block->Statements[i];
+                for (uint32_t i = 0; i < count; i++) {
                     printIndentation(stream, indentation + 2);
                     fprintf(stream, "{\n");
-                    dumpStatement(stream, statement, indentation + 3);
+                    dumpStatement(stream, ast, blockStatements(ast, statement)[i], indentation + 3);
                     fprintf(stream, "\n");
                     printIndentation(stream, indentation + 2);
-                    fprintf(stream, "}%s\n", i + 1 != block->Count ? "," : "\0");
+                    fprintf(stream, "}%s\n", i + 1 != count ? "," : "\0");
                 }
                 printIndentation(stream, indentation + 1);
             }
             fprintf(stream, "]");
         } break;
-        case STATEMENT_IF: {
-            IfStatement ifStatement = statement->If;
+        case NODE_IF: {
+            NodeIndex elseBlock = ifElseBlock(ast, statement);
             fprintf(stream, "\"If\": {\n");
             printIndentation(stream, indentation + 1);
             fprintf(stream, "\"Condition\": ");
-            dumpExpression(stream, ifStatement.Condition, indentation + 1);
+            dumpExpression(stream, ast, nodeFirst(ast, statement), indentation + 1);
             fprintf(stream, ",\n");
             printIndentation(stream, indentation + 1);
             fprintf(stream, "\"Block\": ");
-            dumpStatement(stream, ifStatement.Block, indentation);
-            if (ifStatement.ElseBlock) {
+            dumpStatement(stream, ast, ifBlock(ast, statement), indentation);
+            if (elseBlock) {
                 fprintf(stream, ",\n");
                 fprintf(stream, "\"Else\": ");
-                dumpStatement(stream, ifStatement.ElseBlock, indentation);
+                dumpStatement(stream, ast, elseBlock, indentation);
             } else {
                 fprintf(stream, "\n");
             }
             printIndentation(stream, indentation);
             fprintf(stream, "}");
         } break;
-        case STATEMENT_RETURN: {
+        case NODE_RETURN: {
             printIndentation(stream, indentation);
             fprintf(stream, "\"Return\": ");
-            dumpExpression(stream, statement->Expresssion, indentation);
+            dumpExpression(stream, ast, nodeFirst(ast, statement), indentation);
         } break;
+        default: break;
     }
 }
 
-void dumpNode(FILE* stream, Node* node) {
-    switch (node->Type) {
-        case NODE_EXPRESSION: dumpExpression(stream, node->Expression, 1); break;
-        case NODE_DECLARATION: dumpDeclaration(stream, node->Declaration, 1); break;
-        case NODE_STATEMENT: dumpStatement(stream, node->Statement, 1); break;
+void dumpNode(FILE* stream, Ast* ast, NodeIndex node) {
+    switch (nodeKind(ast, node)) {
         case NODE_PROGRAM: {
             printf("{\n");
-            ProgramNode* program = node->Program;
-            for (int i = 0; i < program->Count; i++) {
-                Node* node = program->Nodes[i];
-                dumpNode(stream, node);
-                fprintf(stream, "%s", i + 1 != program->Count ? ",\n" : "\0");
+            uint32_t count = blockCount(ast, node);
+            for (uint32_t i = 0; i < count; i++) {
+                dumpNode(stream, ast, blockStatements(ast, node)[i]);
+                fprintf(stream, "%s", i + 1 != count ? ",\n" : "\0");
             }
             printf("\n}\n");
         } break;
+        default: dumpStatement(stream, ast, node, 1); break;
     }
 }
@@ -4,294 +4,586 @@
 #include "Token.h"
 #include "Node.h"
 #include <stdlib.h>
-#include <string.h>
 
-static Expression* parseExpression(Parser* parser);
-static Expression** parseExpressionList(Parser* parser);
-static Statement* parseStatement(Parser* parser);
+static NodeIndex parseExpression(Parser* parser);
+static const NodeIndex* parseExpressionList(Parser* parser, uint32_t* count);
+static NodeIndex parseStatement(Parser* parser);
+static void fillTokens(Parser* parser);
 
-Parser* newParser(Token* tokens) {
+Parser* newParser(TokenStream* tokens, Ast* ast) {
     Parser* parser = calloc(1, sizeof(Parser));
     parser->Tokens = tokens;
-    parser->CurrentToken = tokens;
+    parser->CurrentToken = 0;
+    parser->Ast = ast;
+    parser->Scratch = newStretchyBuffer(sizeof(NodeIndex));
+    return parser;
+}
+
+Parser* newStreamingParser(Lexer* lexer, Ast* ast) {
+    Parser* parser = newParser(lexer->Tokens, ast);
+    parser->Lexer = lexer;
+    fillTokens(parser);
     return parser;
 }
 
 void freeParser(Parser* parser) {
+    freeStretchyBuffer(parser->Scratch);
     free(parser);
 }
 
-static Token scanToken(Parser* parser) {
-    return *parser->CurrentToken++;
+/*
+    Lists are collected on the parser's scratch stack while they are being parsed, since nested lists interleave.
+    Once a list is complete it is popped off the stack and handed to a node constructor, which copies it into the
+    tree's extra data. The popped list stays valid until the next push.
+*/
+static size_t scratchMark(Parser* parser) {
+    return bufferLength(parser->Scratch);
 }
 
-static Token peek(Parser* parser) {
-    Token peeked = *(parser->CurrentToken + 1);
-    return peeked;
+static void pushScratch(Parser* parser, NodeIndex node) {
+    bufferPush(parser->Scratch, node);
 }
 
-static bool consume(Parser* parser, const char* lexeme) {
-    size_t lexemeLength = strlen(lexeme);
-    if (parser->CurrentToken->Length == lexemeLength && strneq(parser->CurrentToken->Lexeme, lexeme, lexemeLength)) {
-        scanToken(parser);
-        return true;
+static const NodeIndex* popScratch(Parser* parser, size_t mark, uint32_t* count) {
+    *count = bufferLength(parser->Scratch) - mark;
+    bufferLength(parser->Scratch) = mark;
+    return parser->Scratch + mark;
+}
+
+/*
+    Make sure the current token and the one after it are lexed. The ring is filled as far as it goes in one go, so
+    the lexer runs in batches rather than a token at a time, while the token just consumed stays readable.
+*/
+static void fillTokens(Parser* parser) {
+    TokenStream* tokens = parser->Tokens;
+    if (parser->Lexer && parser->CurrentToken + 1 >= tokens->Count) {
+        pullTokens(parser->Lexer, parser->CurrentToken + tokens->Capacity - 1 - tokens->Count);
     }
-    return false;
 }
 
-static bool consumePunctuator(Parser* parser, const char* punctuator) {
-    return parser->CurrentToken->Type == TOKEN_PUNCTUATOR && consume(parser, punctuator);
+/*
+    Consume the current token. The parser stays on EOF once it gets there, however malformed the input.
+*/
+static TokenIndex scanToken(Parser* parser) {
+    TokenIndex token = parser->CurrentToken;
+    if (tokenKind(parser->Tokens, token) != KIND_EOF) {
+        parser->CurrentToken++;
+        fillTokens(parser);
+    }
+    return token;
 }
 
-static bool consumeKeyword(Parser* parser, const char* keyword) {
-    return parser->CurrentToken->Type == TOKEN_KEYWORD && consume(parser, keyword);
+static TokenKind currentKind(Parser* parser) {
+    return tokenKind(parser->Tokens, parser->CurrentToken);
 }
 
-static Token expectIdentifier(Parser* parser) {
-    Token token = *parser->CurrentToken;
-    if (token.Type == TOKEN_IDENTIFIER) {
-        scanToken(parser);
-    }
+static TokenKind peekKind(Parser* parser) {
+    return tokenKind(parser->Tokens, parser->CurrentToken + 1);
+}
 
-    return token;
+static bool match(Parser* parser, TokenKind kind) {
+    return currentKind(parser) == kind;
 }
 
-static Token expectKeyword(Parser* parser, const char* keyword) {
-    Token token = *parser->CurrentToken;
-    if (token.Type == TOKEN_KEYWORD && strneq(token.Lexeme, keyword, token.Length)) {
+static bool consume(Parser* parser, TokenKind kind) {
+    if (match(parser, kind)) {
         scanToken(parser);
+        return true;
     }
-
-    return token;
+    return false;
 }
 
-static Token expectPunctuator(Parser* parser, const char* punctuator) {
-    Token token = *parser->CurrentToken;
-    if (token.Type == TOKEN_PUNCTUATOR && strneq(token.Lexeme, punctuator, token.Length)) {
-        scanToken(parser);
+static Symbol expectIdentifier(Parser* parser) {
+    if (match(parser, KIND_IDENTIFIER)) {
+        return tokenSymbol(parser->Tokens, scanToken(parser));
     }
 
-    return token;
+    return SYMBOL_NONE;
 }
 
-static bool matchKeyword(Parser* parser, const char* keyword) {
-    return parser->CurrentToken->Type == TOKEN_KEYWORD && strneq(parser->CurrentToken->Lexeme, keyword, parser->CurrentToken->Length);
-}
+static TokenIndex expect(Parser* parser, TokenKind kind) {
+    TokenIndex token = parser->CurrentToken;
+    if (match(parser, kind)) {
+        scanToken(parser);
+    }
 
-static bool matchPunctuator(Parser* parser, const char* punctuator) {
-    return parser->CurrentToken->Type == TOKEN_PUNCTUATOR && strneq(parser->CurrentToken->Lexeme, punctuator, parser->CurrentToken->Length);
+    return token;
 }
 
-static Operation tokenToOperation(Token token) {
-    for (Operation operation = 0; operation < OPERATION_UNKNOWN; operation++) {
-        if (strneq(token.Lexeme, OPERATION_TO_STRING[operation], token.Length)) {
-            return operation;
-        }
+static Operation tokenToOperation(TokenKind kind) {
+    switch (kind) {
+        case PUNCTUATOR_PLUS: return OPERATION_ADD;
+        case PUNCTUATOR_MINUS: return OPERATION_SUBTRACT;
+        case PUNCTUATOR_ASTERISK: return OPERATION_MULTIPLY;
+        case PUNCTUATOR_SLASH: return OPERATION_DIVIDE;
+        case PUNCTUATOR_GREATER: return OPERATION_GREATER_THAN;
+        case PUNCTUATOR_GREATER_EQUAL: return OPERATION_GREATER_THAN_OR_EQUAL;
+        case PUNCTUATOR_LESS: return OPERATION_LESS_THAN;
+        case PUNCTUATOR_LESS_EQUAL: return OPERATION_LESS_THAN_OR_EQUAL;
+        case PUNCTUATOR_EQUAL_EQUAL: return OPERATION_EQUAL_TO;
+        case PUNCTUATOR_NOT_EQUAL: return OPERATION_NOT_EQUAL_TO;
+        default: return OPERATION_UNKNOWN;
     }
-
-    return OPERATION_UNKNOWN;
 }
 
-static Expression* parseFunctionCall(Parser* parser) {
+static NodeIndex parseFunctionCall(Parser* parser) {
 
-    Token functionName = expectIdentifier(parser);
-    Token functionStart = expectPunctuator(parser, "(");
-    Expression** arguments = parseExpressionList(parser);
-    Token functionEnd = expectPunctuator(parser, ")");
-    
-    size_t arity = bufferLength(arguments);
+    Symbol functionName = expectIdentifier(parser);
+    TokenIndex functionStart = expect(parser, PUNCTUATOR_LEFT_PARENTHESIS);
+    uint32_t arity = 0;
+    const NodeIndex* arguments = parseExpressionList(parser, &arity);
+    TokenIndex functionEnd = expect(parser, PUNCTUATOR_RIGHT_PARENTHESIS);
 
-    Expression* call = newFunctionCall(functionName.Name, arguments, arity);
+    NodeIndex call = newFunctionCall(parser->Ast, functionName, arguments, arity);
     return call;
 }
 
-static Expression* parsePrimary(Parser* parser) {
-    Token token = *parser->CurrentToken;
-    switch (token.Type) {
-        case TOKEN_INTEGER: {
-            int value = token.Integer;
-            scanToken(parser);
-            return newIntegerLiteral(value);
+static NodeIndex parsePrimary(Parser* parser) {
+    switch (currentKind(parser)) {
+        case KIND_INTEGER: {
+            int value = tokenInteger(parser->Tokens, scanToken(parser));
+            return newIntegerLiteral(parser->Ast, value);
         } break;
-        case TOKEN_IDENTIFIER: {
-            Token peeked = peek(parser);
-            if (strneq(peeked.Lexeme, "(", peeked.Length)) {
+        case KIND_IDENTIFIER: {
+            if (peekKind(parser) == PUNCTUATOR_LEFT_PARENTHESIS) {
                 return parseFunctionCall(parser);
             }
 
-            scanToken(parser);
-            return newVariable(token.Name);
+            return newVariable(parser->Ast, tokenSymbol(parser->Tokens, scanToken(parser)));
         } break;
-        case TOKEN_PUNCTUATOR: {
-            if (consume(parser, "(")) {
-                Expression* expression = parseExpression(parser);
-                consume(parser, ")");
-                return expression;
-            }
+        case KIND_STRING: {
+            return newStringLiteral(parser->Ast, tokenSymbol(parser->Tokens, scanToken(parser)));
+        } break;
+        case PUNCTUATOR_LEFT_PARENTHESIS: {
+            scanToken(parser);
+            NodeIndex expression = parseExpression(parser);
+            consume(parser, PUNCTUATOR_RIGHT_PARENTHESIS);
+            return expression;
         }
+        default: break;
     }
 
-    return NULL;
+    return NODE_NONE;
 }
 
-static Expression* parseBinaryExpression(Parser* parser, int previousPrecedence) {
-    Expression* left = NULL;
+static NodeIndex parseBinaryExpression(Parser* parser, int previousPrecedence) {
+    NodeIndex left = NODE_NONE;
     
     left = parsePrimary(parser);
-    Operation operation = tokenToOperation(*parser->CurrentToken);
+    Operation operation = tokenToOperation(currentKind(parser));
     while (operatorPrecedence(operation) > previousPrecedence) {
         scanToken(parser);
-        Expression* right = parseBinaryExpression(parser, operatorPrecedence(operation));
-        left = newBinaryExpression(operation, left, right);
-        operation = tokenToOperation(*parser->CurrentToken);
+        NodeIndex right = parseBinaryExpression(parser, operatorPrecedence(operation));
+        left = newBinaryExpression(parser->Ast, operation, left, right);
+        operation = tokenToOperation(currentKind(parser));
     }
 
     return left;
 }
 
-static Expression* parseExpression(Parser* parser) {
+static NodeIndex parseExpression(Parser* parser) {
     return parseBinaryExpression(parser, 0);
 }
 
-static Expression** parseExpressionList(Parser* parser) {
-    Expression** expressionList = newStretchyBuffer(sizeof(Expression*));
+static const NodeIndex* parseExpressionList(Parser* parser, uint32_t* count) {
+    size_t mark = scratchMark(parser);
 
-    Expression* expression = parseExpression(parser);
+    NodeIndex expression = parseExpression(parser);
     if (expression) {
-        bufferPush(expressionList, expression);
-        while (consumePunctuator(parser, ",")) {
+        pushScratch(parser, expression);
+        while (consume(parser, PUNCTUATOR_COMMA)) {
             expression = parseExpression(parser);
-            bufferPush(expressionList, expression);
+            pushScratch(parser, expression);
         }
     }
 
-    return expressionList;
+    return popScratch(parser, mark, count);
 }
 
-static Statement* parseBlock(Parser* parser) {
-    Statement* block = newStatementBlock();
+static NodeIndex parseBlock(Parser* parser) {
+    size_t mark = scratchMark(parser);
 
-    Token blockStart = expectPunctuator(parser, "{");
-    while (!matchPunctuator(parser, "}")) {
-        Statement* statement = parseStatement(parser);
-        addStatement(block->Block, statement);
+    TokenIndex blockStart = expect(parser, PUNCTUATOR_LEFT_BRACE);
+    while (!match(parser, PUNCTUATOR_RIGHT_BRACE) && !match(parser, KIND_EOF)) {
+        NodeIndex statement = parseStatement(parser);
+        pushScratch(parser, statement);
     }
-    Token blockEnd = expectPunctuator(parser, "}");
-    
-    return block;
+    TokenIndex blockEnd = expect(parser, PUNCTUATOR_RIGHT_BRACE);
+
+    uint32_t count = 0;
+    const NodeIndex* statements = popScratch(parser, mark, &count);
+    return newStatementBlock(parser->Ast, statements, count);
 }
 
-static Declaration* parseVariableDeclaration(Parser* parser) {
+/*
+    Skip a block by matching braces and leave a LAZY_BLOCK in its place. A block that never closes runs up to EOF.
+*/
+static NodeIndex skipBlock(Parser* parser) {
+    TokenStream* tokens = parser->Tokens;
+    TokenIndex start = parser->CurrentToken;
+    TokenIndex token = start;
+    uint32_t depth = 0;
+    do {
+        TokenKind kind = tokenKind(tokens, token);
+        if (kind == KIND_EOF) break;
+        depth += kind == PUNCTUATOR_LEFT_BRACE;
+        depth -= kind == PUNCTUATOR_RIGHT_BRACE;
+        token++;
+    } while (depth > 0);
+
+    parser->CurrentToken = token;
+    parser->SkippedBodies++;
+    return newLazyBlock(parser->Ast, start, token);
+}
+
+static NodeIndex parseVariableDeclaration(Parser* parser) {
 
-    Token qualifier = expectKeyword(parser, "let");
-    Token variableName = expectIdentifier(parser);
-    Token variableType;
-    if (consumePunctuator(parser, ":")) {
+    TokenIndex qualifier = expect(parser, KEYWORD_LET);
+    Symbol variableName = expectIdentifier(parser);
+    TokenIndex variableType;
+    if (consume(parser, PUNCTUATOR_COLON)) {
         variableType = scanToken(parser);
     }
-    Expression* initializer = NULL;
-    if (consumePunctuator(parser, "=")) {
+    NodeIndex initializer = NODE_NONE;
+    if (consume(parser, PUNCTUATOR_EQUAL)) {
         initializer = parseExpression(parser);
     }
-    Token declarationEnd = expectPunctuator(parser, ";");
+    TokenIndex declarationEnd = expect(parser, PUNCTUATOR_SEMICOLON);
 
-    Declaration* variableDeclaration = newVariableDeclaration(variableName.Name, initializer);
+    NodeIndex variableDeclaration = newVariableDeclaration(parser->Ast, variableName, initializer);
     return variableDeclaration;
 }
 
-static Declaration** parseFunctionParameters(Parser* parser) {
-    Declaration** parameters = newStretchyBuffer(sizeof(Declaration*));
-    
+/*
+    Push the parameters onto the scratch stack. They stay there while the body is parsed, until the declaration is
+    built.
+*/
+static void parseFunctionParameters(Parser* parser) {
     // TODO: proper validation
 
-    Declaration* parameter = NULL;
-    if (parser->CurrentToken->Type == TOKEN_IDENTIFIER) {
-        Token parameterName = expectIdentifier(parser);
-        expectPunctuator(parser, ":");
-        Token parameterType = scanToken(parser);
+    NodeIndex parameter = NODE_NONE;
+    while (match(parser, KIND_IDENTIFIER)) {
+        Symbol parameterName = expectIdentifier(parser);
+        expect(parser, PUNCTUATOR_COLON);
+        TokenIndex parameterType = scanToken(parser);
 
-        parameter = newVariableDeclaration(parameterName.Name, NULL);
-        bufferPush(parameters, parameter);
+        parameter = newVariableDeclaration(parser->Ast, parameterName, NODE_NONE);
+        pushScratch(parser, parameter);
+        if (!consume(parser, PUNCTUATOR_COMMA)) break;
     }
-
-    return parameters;
 }
 
-static Declaration* parseFunctionDeclaration(Parser* parser) {
+static NodeIndex parseFunctionDeclaration(Parser* parser) {
 
-    Token functionKeyword = expectKeyword(parser, "function");
-    Token functionName = expectIdentifier(parser);
-    expectPunctuator(parser, "(");
-    Declaration** parameters = parseFunctionParameters(parser);
-    size_t arity = bufferLength(parameters);
-    expectPunctuator(parser, ")");
-    if (consumePunctuator(parser, ":")) {
-        Token functionReturnType = scanToken(parser);
+    TokenIndex functionKeyword = expect(parser, KEYWORD_FUNCTION);
+    Symbol functionName = expectIdentifier(parser);
+    expect(parser, PUNCTUATOR_LEFT_PARENTHESIS);
+    size_t mark = scratchMark(parser);
+    parseFunctionParameters(parser);
+    expect(parser, PUNCTUATOR_RIGHT_PARENTHESIS);
+    if (consume(parser, PUNCTUATOR_COLON)) {
+        TokenIndex functionReturnType = scanToken(parser);
     }
     
-    Statement* block = parseBlock(parser);
+    NodeIndex block = parser->LazyBodies && match(parser, PUNCTUATOR_LEFT_BRACE) ? skipBlock(parser) : parseBlock(parser);
 
-    Declaration* functionDeclaration = newFunctionDeclaration(functionName.Name, parameters, arity, "void", block);
+    uint32_t arity = 0;
+    const NodeIndex* parameters = popScratch(parser, mark, &arity);
+    NodeIndex functionDeclaration = newFunctionDeclaration(parser->Ast, functionName, parameters, arity, block);
     return functionDeclaration;
 }
 
-static Statement* parseIfStatement(Parser* parser) {
-    expectKeyword(parser, "if");
-    expectPunctuator(parser, "(");
-    Expression* condition = parseExpression(parser);
-    expectPunctuator(parser, ")");
-    Statement* block = parseBlock(parser);
-    Statement* elseBlock = NULL;
+static NodeIndex parseIfStatement(Parser* parser) {
+    expect(parser, KEYWORD_IF);
+    expect(parser, PUNCTUATOR_LEFT_PARENTHESIS);
+    NodeIndex condition = parseExpression(parser);
+    expect(parser, PUNCTUATOR_RIGHT_PARENTHESIS);
+    NodeIndex block = parseBlock(parser);
+    NodeIndex elseBlock = NODE_NONE;
 
-    if (consumeKeyword(parser, "else")) {
+    if (consume(parser, KEYWORD_ELSE)) {
         elseBlock = parseBlock(parser);
     }
 
-    Statement* ifStatement = newIfStatement(condition, block, elseBlock);
+    NodeIndex ifStatement = newIfStatement(parser->Ast, condition, block, elseBlock);
     return ifStatement;
 }
 
-static Statement* parseReturnStatement(Parser* parser) {
-    expectKeyword(parser, "return");
-    Expression* expression = parseExpression(parser);
-    expectPunctuator(parser, ";");
-    Statement* returnStatement = newReturnStatement(expression);
+static NodeIndex parseReturnStatement(Parser* parser) {
+    expect(parser, KEYWORD_RETURN);
+    NodeIndex expression = parseExpression(parser);
+    expect(parser, PUNCTUATOR_SEMICOLON);
+    NodeIndex returnStatement = newReturnStatement(parser->Ast, expression);
     return returnStatement;
 }
 
-static Statement* parseStatement(Parser* parser) {
-    Statement* statement = NULL;
-    Token token = *parser->CurrentToken;
-
-    switch (token.Type) {
-        case TOKEN_KEYWORD: {
-            if (matchKeyword(parser, "function")) {
-                statement = newDeclarationStatement(parseFunctionDeclaration(parser));
-            } else if (matchKeyword(parser, "let")) {
-                statement = newDeclarationStatement(parseVariableDeclaration(parser));
-            } else if (matchKeyword(parser, "if")) {
-                statement = parseIfStatement(parser);
-            } else if (matchKeyword(parser, "return")) {
-                statement = parseReturnStatement(parser);
-            }
-        } break;
+static NodeIndex parseStatement(Parser* parser) {
+    NodeIndex statement = NODE_NONE;
+
+    switch (currentKind(parser)) {
+        case KEYWORD_FUNCTION: statement = parseFunctionDeclaration(parser); break;
+        case KEYWORD_LET: statement = parseVariableDeclaration(parser); break;
+        case KEYWORD_IF: statement = parseIfStatement(parser); break;
+        case KEYWORD_RETURN: statement = parseReturnStatement(parser); break;
         default: {
-            statement = newExpressionStatement(parseExpression(parser));
-            expectPunctuator(parser, ";");
+            NodeIndex expression = parseExpression(parser);
+            if (!expression) {
+                // Skip a token that can't start a statement so the parser always makes progress.
+                scanToken(parser);
+            }
+            statement = newExpressionStatement(parser->Ast, expression);
+            expect(parser, PUNCTUATOR_SEMICOLON);
         }
     }
 
     return statement;
 }
 
-Node* parse(Parser* parser) {
-    Node* program = newProgramNode();
-    Token token = *parser->CurrentToken;
-    while (token.Type != TOKEN_EOF) {
-        Statement* statement = parseStatement(parser);
-        addNode(program->Program, newStatementNode(statement));
-        token = *parser->CurrentToken;
+/*
+    A top-level function declaration parsed ahead of time by parseParallel, and where its nodes are in its batch's
+    tree.
+*/
+typedef struct ParsedDeclaration {
+    TokenIndex Start;
+    // Token the parser stopped at after the declaration.
+    TokenIndex End;
+    Ast* Ast;
+    NodeIndex FirstNode;
+    NodeIndex Root;
+    uint32_t FirstExtra;
+    uint32_t ExtraEnd;
+} ParsedDeclaration;
+
+/*
+    Parse the top-level statements, taking the ones that start where a declaration was parsed ahead of time from its
+    batch instead of parsing them again.
+*/
+static NodeIndex parseProgram(Parser* parser, ParsedDeclaration* declarations, uint32_t declarationCount) {
+    size_t mark = scratchMark(parser);
+    uint32_t nextDeclaration = 0;
+    while (!match(parser, KIND_EOF)) {
+        // A malformed statement may have run past declarations; those were parsed as part of it.
+        while (nextDeclaration < declarationCount && declarations[nextDeclaration].Start < parser->CurrentToken) {
+            nextDeclaration++;
+        }
+
+        NodeIndex statement = NODE_NONE;
+        if (nextDeclaration < declarationCount && declarations[nextDeclaration].Start == parser->CurrentToken) {
+            ParsedDeclaration* declaration = &declarations[nextDeclaration++];
+            NodeIndex base = copyNodes(parser->Ast, declaration->Ast, declaration->FirstNode, declaration->Root + 1,
+                declaration->FirstExtra, declaration->ExtraEnd);
+            statement = base + declaration->Root - declaration->FirstNode;
+            parser->CurrentToken = declaration->End;
+        } else {
+            statement = parseStatement(parser);
+        }
+        pushScratch(parser, statement);
     }
 
+    uint32_t count = 0;
+    const NodeIndex* statements = popScratch(parser, mark, &count);
+    parser->Ast->Root = newProgramNode(parser->Ast, statements, count);
+    return parser->Ast->Root;
+}
+
+NodeIndex parse(Parser* parser) {
+    return parseProgram(parser, NULL, 0);
+}
+
+// Fewest tokens worth handing to a worker.
+#define PARALLEL_BATCH_MINIMUM (64 * 1024)
+
+typedef struct ParseBatch {
+    TokenStream* Tokens;
+    bool LazyBodies;
+    uint32_t SkippedBodies;
+    ParsedDeclaration* Declarations;
+    uint32_t DeclarationCount;
+    Ast* Ast;
+} ParseBatch;
+
+static void parseBatch(void* argument) {
+    ParseBatch* batch = argument;
+    Ast* ast = batch->Ast;
+    Parser* parser = newParser(batch->Tokens, ast);
+    parser->LazyBodies = batch->LazyBodies;
+    for (uint32_t i = 0; i < batch->DeclarationCount; i++) {
+        ParsedDeclaration* declaration = &batch->Declarations[i];
+        parser->CurrentToken = declaration->Start;
+        declaration->Ast = ast;
+        declaration->FirstNode = ast->Count;
+        declaration->FirstExtra = bufferLength(ast->Extra);
+        declaration->Root = parseStatement(parser);
+        declaration->ExtraEnd = bufferLength(ast->Extra);
+        declaration->End = parser->CurrentToken;
+    }
+    batch->SkippedBodies = parser->SkippedBodies;
+    freeParser(parser);
+}
+
+NodeIndex parseParallel(Parser* parser, ThreadPool* pool) {
+    TokenStream* tokens = parser->Tokens;
+    // Several batches per worker even out functions of different sizes.
+    uint32_t batchCount = pool->ThreadCount * 4;
+    if (tokens->Count / PARALLEL_BATCH_MINIMUM < batchCount) {
+        batchCount = tokens->Count / PARALLEL_BATCH_MINIMUM;
+    }
+    if (batchCount < 2 || parser->Lexer) {
+        return parse(parser);
+    }
+
+    // Find the function declarations outside any braces. Parsing a statement only depends on the tokens from its
+    // start, so a declaration parsed on its own comes out exactly as it would in order.
+    ParsedDeclaration* declarations = newStretchyBuffer(sizeof(ParsedDeclaration));
+    uint32_t depth = 0;
+    for (TokenIndex token = parser->CurrentToken; token < tokens->Count; token++) {
+        switch (tokenKind(tokens, token)) {
+            case PUNCTUATOR_LEFT_BRACE: depth++; break;
+            case PUNCTUATOR_RIGHT_BRACE: depth -= depth > 0; break;
+            case KEYWORD_FUNCTION: {
+                if (depth == 0) {
+                    ParsedDeclaration declaration = { .Start = token };
+                    bufferPush(declarations, declaration);
+                }
+            } break;
+            default: break;
+        }
+    }
+    uint32_t declarationCount = bufferLength(declarations);
+
+    // Split the declarations into batches of roughly equal token counts.
+    ParseBatch* batches = calloc(batchCount, sizeof(ParseBatch));
+    uint32_t usedBatches = 0;
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < batchCount && first < declarationCount; i++) {
+        TokenIndex limit = (uint64_t)tokens->Count * (i + 1) / batchCount;
+        uint32_t end = first;
+        while (end < declarationCount && (declarations[end].Start < limit || i + 1 == batchCount)) {
+            end++;
+        }
+        if (end == first) continue;
+
+        TokenIndex endToken = end < declarationCount ? declarations[end].Start : tokens->Count;
+        batches[usedBatches++] = (ParseBatch) {
+            .Tokens = tokens,
+            .LazyBodies = parser->LazyBodies,
+            .Declarations = declarations + first,
+            .DeclarationCount = end - first,
+            .Ast = newAst((endToken - declarations[first].Start) / 2),
+        };
+        first = end;
+    }
+
+    for (uint32_t i = 0; i < usedBatches; i++) {
+        submitTask(pool, parseBatch, &batches[i]);
+    }
+    waitForTasks(pool);
+
+    NodeIndex program = parseProgram(parser, declarations, declarationCount);
+
+    // Only count the bodies of the declarations the program ended up using.
+    parser->SkippedBodies = 0;
+    for (NodeIndex node = 0; node < parser->Ast->Count; node++) {
+        parser->SkippedBodies += nodeKind(parser->Ast, node) == NODE_LAZY_BLOCK;
+    }
+    for (uint32_t i = 0; i < usedBatches; i++) {
+        freeAst(batches[i].Ast);
+    }
+    free(batches);
+    freeStretchyBuffer(declarations);
     return program;
-}
\ No newline at end of file
+}
+NodeIndex parseFunctionBody(Parser* parser, NodeIndex function) {
+    Ast* ast = parser->Ast;
+    NodeIndex block = functionBlock(ast, function);
+    if (nodeKind(ast, block) != NODE_LAZY_BLOCK) return block;
+
+    TokenIndex currentToken = parser->CurrentToken;
+    bool lazyBodies = parser->LazyBodies;
+    parser->CurrentToken = lazyBlockStart(ast, block);
+    parser->LazyBodies = false;
+    block = parseBlock(parser);
+    functionBlock(ast, function) = block;
+    parser->CurrentToken = currentToken;
+    parser->LazyBodies = lazyBodies;
+    parser->SkippedBodies--;
+    return block;
+}
+
+/*
+    Queue the functions called anywhere under `node` that haven't been queued yet. Queued functions are removed
+    from `functions`, which maps symbols to top-level declarations.
+*/
+static void queueCalls(Ast* ast, NodeIndex node, NodeIndex* functions, NodeIndex** queue) {
+    switch (nodeKind(ast, node)) {
+        case NODE_CALL: {
+            Symbol name = nodeFirst(ast, node);
+            if (functions[name]) {
+                bufferPush((*queue), functions[name]);
+                functions[name] = NODE_NONE;
+            }
+            for (uint32_t i = 0; i < callArity(ast, node); i++) {
+                queueCalls(ast, callArguments(ast, node)[i], functions, queue);
+            }
+        } break;
+        case NODE_UNARY:
+        case NODE_EXPRESSION_STATEMENT:
+        case NODE_RETURN: {
+            queueCalls(ast, nodeFirst(ast, node), functions, queue);
+        } break;
+        case NODE_BINARY: {
+            queueCalls(ast, nodeFirst(ast, node), functions, queue);
+            queueCalls(ast, nodeSecond(ast, node), functions, queue);
+        } break;
+        case NODE_VARIABLE_DECLARATION: {
+            queueCalls(ast, nodeSecond(ast, node), functions, queue);
+        } break;
+        case NODE_PROGRAM:
+        case NODE_BLOCK: {
+            for (uint32_t i = 0; i < blockCount(ast, node); i++) {
+                queueCalls(ast, blockStatements(ast, node)[i], functions, queue);
+            }
+        } break;
+        case NODE_IF: {
+            queueCalls(ast, nodeFirst(ast, node), functions, queue);
+            queueCalls(ast, ifBlock(ast, node), functions, queue);
+            queueCalls(ast, ifElseBlock(ast, node), functions, queue);
+        } break;
+        case NODE_FUNCTION_DECLARATION: {
+            queueCalls(ast, functionBlock(ast, node), functions, queue);
+        } break;
+        default: break;
+    }
+}
+
+uint32_t parseReachableFunctions(Parser* parser, Symbol entry) {
+    Ast* ast = parser->Ast;
+    NodeIndex program = ast->Root;
+    uint32_t symbols = symbolCount();
+    NodeIndex* functions = calloc(symbols, sizeof(NodeIndex));
+    for (uint32_t i = 0; i < blockCount(ast, program); i++) {
+        NodeIndex statement = blockStatements(ast, program)[i];
+        Symbol name = nodeFirst(ast, statement);
+        if (nodeKind(ast, statement) == NODE_FUNCTION_DECLARATION && name != SYMBOL_NONE && !functions[name]) {
+            functions[name] = statement;
+        }
+    }
+
+    NodeIndex* queue = newStretchyBuffer(sizeof(NodeIndex));
+    if (entry < symbols && functions[entry]) {
+        bufferPush(queue, functions[entry]);
+        functions[entry] = NODE_NONE;
+    }
+
+    uint32_t parsedBodies = 0;
+    while (bufferLength(queue) > 0) {
+        NodeIndex function = queue[--bufferLength(queue)];
+        parsedBodies += nodeKind(ast, functionBlock(ast, function)) == NODE_LAZY_BLOCK;
+        NodeIndex block = parseFunctionBody(parser, function);
+        queueCalls(ast, block, functions, &queue);
+    }
+
+    freeStretchyBuffer(queue);
+    free(functions);
+    return parsedBodies;
+}
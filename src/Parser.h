@@ -3,16 +3,57 @@
 
 #include "Common.h"
 #include "Token.h"
+#include "Lexer.h"
 #include "Node.h"
+#include "ThreadPool.h"
 
 typedef struct Parser {
-    Token* Tokens;
-    Token* CurrentToken;
+    TokenStream* Tokens;
+    TokenIndex CurrentToken;
+    // Lexer to pull tokens from when parsing from a token ring, NULL when all tokens were lexed up front.
+    Lexer* Lexer;
+    Ast* Ast;
+    NodeIndex* Scratch;
+    // Skip function bodies by matching braces instead of parsing them. Bodies are parsed later on demand.
+    bool LazyBodies;
+    uint32_t SkippedBodies;
 } Parser;
 
-Parser* newParser(Token* tokens);
+/*
+    Create a parser over a token stream. Nodes are added to `ast`, which the caller owns.
+*/
+Parser* newParser(TokenStream* tokens, Ast* ast);
+
+/*
+    Create a parser that pulls tokens from a streaming lexer as it goes, refilling the lexer's ring whenever the
+    next token is needed. The parser never refers further back than the token it just consumed.
+*/
+Parser* newStreamingParser(Lexer* lexer, Ast* ast);
 void freeParser(Parser* parser);
 
-Node* parse(Parser* parser);
+/*
+    Parse the whole program and return its PROGRAM node, which is also recorded as the tree's root.
+*/
+NodeIndex parse(Parser* parser);
+
+/*
+    Parse the whole program like parse, with the top-level function declarations parsed ahead of time in batches on
+    the workers of `pool`, each batch into a tree of its own. A pre-pass finds the declarations by matching braces,
+    and their nodes are copied into the parser's tree in source order, so the result is identical to parse. Small
+    programs and streaming parsers are parsed serially.
+*/
+NodeIndex parseParallel(Parser* parser, ThreadPool* pool);
+
+/*
+    Parse the body of a function declaration that was skipped with LazyBodies and return its block. Bodies that
+    were already parsed are returned as they are.
+*/
+NodeIndex parseFunctionBody(Parser* parser, NodeIndex function);
+
+/*
+    Parse the skipped bodies of every top-level function reachable through calls from the function named `entry`.
+    The rest stay LAZY_BLOCKs. Returns the number of bodies parsed.
+*/
+uint32_t parseReachableFunctions(Parser* parser, Symbol entry);
 
 #endif
\ No newline at end of file
@@ -1,6 +0,0 @@
-#ifndef READ_FILE_H
-#define READ_FILE_H
-
-char* readFile(const char* filepath);
-
-#endif
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "ScanKernels.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAS_X86_KERNELS 1
+#endif
+
+#define SPACE CHARACTER_SPACE
+#define DIGIT (CHARACTER_DIGIT | CHARACTER_IDENTIFIER)
+#define ALPHA (CHARACTER_ALPHA | CHARACTER_IDENTIFIER)
+
+const uint8_t CHARACTER_CLASS[256] = {
+    ['\t'] = SPACE, ['\n'] = SPACE, ['\v'] = SPACE, ['\f'] = SPACE, ['\r'] = SPACE, [' '] = SPACE,
+    ['0'] = DIGIT, ['1'] = DIGIT, ['2'] = DIGIT, ['3'] = DIGIT, ['4'] = DIGIT,
+    ['5'] = DIGIT, ['6'] = DIGIT, ['7'] = DIGIT, ['8'] = DIGIT, ['9'] = DIGIT,
+    ['A'] = ALPHA, ['B'] = ALPHA, ['C'] = ALPHA, ['D'] = ALPHA, ['E'] = ALPHA, ['F'] = ALPHA, ['G'] = ALPHA,
+    ['H'] = ALPHA, ['I'] = ALPHA, ['J'] = ALPHA, ['K'] = ALPHA, ['L'] = ALPHA, ['M'] = ALPHA, ['N'] = ALPHA,
+    ['O'] = ALPHA, ['P'] = ALPHA, ['Q'] = ALPHA, ['R'] = ALPHA, ['S'] = ALPHA, ['T'] = ALPHA, ['U'] = ALPHA,
+    ['V'] = ALPHA, ['W'] = ALPHA, ['X'] = ALPHA, ['Y'] = ALPHA, ['Z'] = ALPHA,
+    ['a'] = ALPHA, ['b'] = ALPHA, ['c'] = ALPHA, ['d'] = ALPHA, ['e'] = ALPHA, ['f'] = ALPHA, ['g'] = ALPHA,
+    ['h'] = ALPHA, ['i'] = ALPHA, ['j'] = ALPHA, ['k'] = ALPHA, ['l'] = ALPHA, ['m'] = ALPHA, ['n'] = ALPHA,
+    ['o'] = ALPHA, ['p'] = ALPHA, ['q'] = ALPHA, ['r'] = ALPHA, ['s'] = ALPHA, ['t'] = ALPHA, ['u'] = ALPHA,
+    ['v'] = ALPHA, ['w'] = ALPHA, ['x'] = ALPHA, ['y'] = ALPHA, ['z'] = ALPHA,
+    ['_'] = CHARACTER_IDENTIFIER,
+};
+
+#undef SPACE
+#undef DIGIT
+#undef ALPHA
+
+static const char* skipWhitespaceScalar(const char* p) {
+    while (isSpaceCharacter(*p)) p++;
+    return p;
+}
+
+static const char* skipIdentifierScalar(const char* p) {
+    while (isIdentifierCharacter(*p)) p++;
+    return p;
+}
+
+static const char* skipDigitsScalar(const char* p) {
+    while (isDigitCharacter(*p)) p++;
+    return p;
+}
+
+static const char* findByteScalar(const char* p, const char* end, char c) {
+    while (p < end && *p != c) p++;
+    return p;
+}
+
+static const ScanKernels SCALAR_KERNELS = {
+    .Name = "scalar",
+    .SkipWhitespace = skipWhitespaceScalar,
+    .SkipIdentifier = skipIdentifierScalar,
+    .SkipDigits = skipDigitsScalar,
+    .FindByte = findByteScalar,
+};
+
+#ifdef HAS_X86_KERNELS
+
+/*
+    All kernels load whole aligned blocks and mask off the bytes before `p`. An aligned block never crosses a page
+    boundary, so reading the rest of the block that holds the last valid byte or the sentinel is always safe.
+
+    Bytes are tested for a range [low, high] with one signed compare by shifting `low` down to -128.
+*/
+#define SSE2_IN_RANGE(x, low, high) \
+        _mm_cmplt_epi8(_mm_add_epi8((x), _mm_set1_epi8((char)(0x80 - (low)))), _mm_set1_epi8((char)(0x80 + (high) - (low) + 1)))
+
+static inline __m128i sse2Whitespace(__m128i x) {
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), SSE2_IN_RANGE(x, '\t', '\r'));
+}
+
+static inline __m128i sse2Digits(__m128i x) {
+    return SSE2_IN_RANGE(x, '0', '9');
+}
+
+static inline __m128i sse2Identifier(__m128i x) {
+    __m128i letters = SSE2_IN_RANGE(_mm_or_si128(x, _mm_set1_epi8(0x20)), 'a', 'z');
+    __m128i underscores = _mm_cmpeq_epi8(x, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(letters, underscores), sse2Digits(x));
+}
+
+#define DEFINE_SSE2_SKIP_KERNEL(name, classify) \
+static const char* name(const char* p) { \
+    size_t misalignment = (uintptr_t)p & 15; \
+    const __m128i* block = (const __m128i*)(p - misalignment); \
+    uint32_t outside = ~(uint32_t)_mm_movemask_epi8(classify(_mm_load_si128(block))) & (0xFFFFu << misalignment) & 0xFFFFu; \
+    while (!outside) { \
+        block++; \
+        outside = ~(uint32_t)_mm_movemask_epi8(classify(_mm_load_si128(block))) & 0xFFFFu; \
+    } \
+    return (const char*)block + __builtin_ctz(outside); \
+}
+
+DEFINE_SSE2_SKIP_KERNEL(skipWhitespaceSse2, sse2Whitespace)
+DEFINE_SSE2_SKIP_KERNEL(skipIdentifierSse2, sse2Identifier)
+DEFINE_SSE2_SKIP_KERNEL(skipDigitsSse2, sse2Digits)
+
+static const char* findByteSse2(const char* p, const char* end, char c) {
+    if (p >= end) return end;
+
+    __m128i pattern = _mm_set1_epi8(c);
+    size_t misalignment = (uintptr_t)p & 15;
+    const __m128i* block = (const __m128i*)(p - misalignment);
+    uint32_t found = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), pattern)) & (0xFFFFu << misalignment);
+    while (!found) {
+        block++;
+        if ((const char*)block >= end) return end;
+        found = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), pattern));
+    }
+
+    const char* match = (const char*)block + __builtin_ctz(found);
+    return match < end ? match : end;
+}
+
+static const ScanKernels SSE2_KERNELS = {
+    .Name = "sse2",
+    .SkipWhitespace = skipWhitespaceSse2,
+    .SkipIdentifier = skipIdentifierSse2,
+    .SkipDigits = skipDigitsSse2,
+    .FindByte = findByteSse2,
+};
+
+#define AVX2 __attribute__((target("avx2")))
+
+#define AVX2_IN_RANGE(x, low, high) \
+        _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(0x80 + (high) - (low) + 1)), _mm256_add_epi8((x), _mm256_set1_epi8((char)(0x80 - (low)))))
+
+static inline AVX2 __m256i avx2Whitespace(__m256i x) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), AVX2_IN_RANGE(x, '\t', '\r'));
+}
+
+static inline AVX2 __m256i avx2Digits(__m256i x) {
+    return AVX2_IN_RANGE(x, '0', '9');
+}
+
+static inline AVX2 __m256i avx2Identifier(__m256i x) {
+    __m256i letters = AVX2_IN_RANGE(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i underscores = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(letters, underscores), avx2Digits(x));
+}
+
+#define DEFINE_AVX2_SKIP_KERNEL(name, classify) \
+static AVX2 const char* name(const char* p) { \
+    size_t misalignment = (uintptr_t)p & 31; \
+    const __m256i* block = (const __m256i*)(p - misalignment); \
+    uint32_t outside = ~(uint32_t)_mm256_movemask_epi8(classify(_mm256_load_si256(block))) & (0xFFFFFFFFu << misalignment); \
+    while (!outside) { \
+        block++; \
+        outside = ~(uint32_t)_mm256_movemask_epi8(classify(_mm256_load_si256(block))); \
+    } \
+    return (const char*)block + __builtin_ctz(outside); \
+}
+
+DEFINE_AVX2_SKIP_KERNEL(skipWhitespaceAvx2, avx2Whitespace)
+DEFINE_AVX2_SKIP_KERNEL(skipIdentifierAvx2, avx2Identifier)
+DEFINE_AVX2_SKIP_KERNEL(skipDigitsAvx2, avx2Digits)
+
+static AVX2 const char* findByteAvx2(const char* p, const char* end, char c) {
+    if (p >= end) return end;
+
+    __m256i pattern = _mm256_set1_epi8(c);
+    size_t misalignment = (uintptr_t)p & 31;
+    const __m256i* block = (const __m256i*)(p - misalignment);
+    uint32_t found = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), pattern)) & (0xFFFFFFFFu << misalignment);
+    while (!found) {
+        block++;
+        if ((const char*)block >= end) return end;
+        found = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), pattern));
+    }
+
+    const char* match = (const char*)block + __builtin_ctz(found);
+    return match < end ? match : end;
+}
+
+static const ScanKernels AVX2_KERNELS = {
+    .Name = "avx2",
+    .SkipWhitespace = skipWhitespaceAvx2,
+    .SkipIdentifier = skipIdentifierAvx2,
+    .SkipDigits = skipDigitsAvx2,
+    .FindByte = findByteAvx2,
+};
+
+#endif
+
+static const ScanKernels* selectedKernels;
+
+const ScanKernels* getScanKernels(void) {
+    if (!selectedKernels) {
+        selectScanKernels("auto");
+    }
+    return selectedKernels;
+}
+
+bool selectScanKernels(const char* name) {
+    const ScanKernels* kernels = NULL;
+    if (streq(name, "scalar")) {
+        kernels = &SCALAR_KERNELS;
+    }
+#ifdef HAS_X86_KERNELS
+    __builtin_cpu_init();
+    bool hasSse2 = __builtin_cpu_supports("sse2");
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (streq(name, "sse2") && hasSse2) {
+        kernels = &SSE2_KERNELS;
+    } else if (streq(name, "avx2") && hasAvx2) {
+        kernels = &AVX2_KERNELS;
+    } else if (streq(name, "auto")) {
+        kernels = hasAvx2 ? &AVX2_KERNELS : hasSse2 ? &SSE2_KERNELS : &SCALAR_KERNELS;
+    }
+#else
+    if (streq(name, "auto")) {
+        kernels = &SCALAR_KERNELS;
+    }
+#endif
+
+    if (!kernels) return false;
+    selectedKernels = kernels;
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef SCAN_KERNELS_H
+#define SCAN_KERNELS_H
+
+#include "Common.h"
+
+/*
+    Character classes of the lexer. Unlike <ctype.h> these don't depend on the locale.
+*/
+#define CHARACTER_SPACE 0x01
+#define CHARACTER_DIGIT 0x02
+#define CHARACTER_ALPHA 0x04
+#define CHARACTER_IDENTIFIER 0x08
+
+extern const uint8_t CHARACTER_CLASS[256];
+
+#define isSpaceCharacter(c) (CHARACTER_CLASS[(uint8_t)(c)] & CHARACTER_SPACE)
+#define isDigitCharacter(c) (CHARACTER_CLASS[(uint8_t)(c)] & CHARACTER_DIGIT)
+#define isAlphaCharacter(c) (CHARACTER_CLASS[(uint8_t)(c)] & CHARACTER_ALPHA)
+#define isIdentifierCharacter(c) (CHARACTER_CLASS[(uint8_t)(c)] & CHARACTER_IDENTIFIER)
+
+/*
+    Kernels for the long runs of the lexer. The skip kernels return the first character at or after `p` that is
+    not in their class; they rely on the source's '\0' sentinel to stop and may read up to the end of the aligned
+    block that contains it, which never crosses into another page.
+*/
+typedef struct ScanKernels {
+    const char* Name;
+    const char* (*SkipWhitespace)(const char* p);
+    const char* (*SkipIdentifier)(const char* p);
+    const char* (*SkipDigits)(const char* p);
+    // First occurrence of `c` in [p, end), or end.
+    const char* (*FindByte)(const char* p, const char* end, char c);
+} ScanKernels;
+
+/*
+    Get the kernels used by the lexer. Unless overridden, the widest instruction set the CPU supports is chosen on
+    first use.
+*/
+const ScanKernels* getScanKernels(void);
+
+/*
+    Force a kernel set by name: "scalar", "sse2", "avx2", or "auto" for the CPUID-based choice.
+
+    Returns false if the name is unknown or the CPU doesn't support it.
+*/
+bool selectScanKernels(const char* name);
+
+#endif
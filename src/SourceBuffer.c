@@ -0,0 +1,88 @@
+#define _DEFAULT_SOURCE
+#include "SourceBuffer.h"
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Files smaller than this are cheaper to read than to map.
+#define SOURCE_MAP_THRESHOLD (64 * 1024)
+
+static bool readSource(SourceBuffer* source, int file, size_t length) {
+    char* data = malloc(length + 1);
+    if (!data) return false;
+
+    size_t total = 0;
+    while (total < length) {
+        ssize_t count = read(file, data + total, length - total);
+        if (count <= 0) break;
+        total += count;
+    }
+    data[total] = '\0';
+
+    source->Data = data;
+    source->Length = total;
+    return true;
+}
+
+/*
+    Reserve one page more than the file needs and map the file over the start of the reservation.
+    The bytes past the end of the file are then always zero, even when its size is a multiple of the page size.
+*/
+static bool mapSource(SourceBuffer* source, int file, size_t length) {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t mappedLength = (length + pageSize) & ~(pageSize - 1);
+
+    void* region = mmap(NULL, mappedLength, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return false;
+
+    if (mmap(region, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, file, 0) == MAP_FAILED) {
+        munmap(region, mappedLength);
+        return false;
+    }
+    madvise(region, length, MADV_SEQUENTIAL);
+
+    source->Data = region;
+    source->Length = length;
+    source->MappedLength = mappedLength;
+    return true;
+}
+
+SourceBuffer* openSourceBuffer(const char* filepath) {
+    int file = open(filepath, O_RDONLY);
+    if (file < 0) return NULL;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || !S_ISREG(status.st_mode)) {
+        close(file);
+        return NULL;
+    }
+
+    SourceBuffer* source = calloc(1, sizeof(SourceBuffer));
+    source->Path = filepath;
+
+    size_t length = status.st_size;
+    bool loaded = length >= SOURCE_MAP_THRESHOLD && mapSource(source, file, length);
+    if (!loaded) {
+        loaded = readSource(source, file, length);
+    }
+    close(file);
+
+    if (!loaded) {
+        free(source);
+        return NULL;
+    }
+    return source;
+}
+
+void freeSourceBuffer(SourceBuffer* source) {
+    if (!source) return;
+
+    if (source->MappedLength) {
+        munmap((void*)source->Data, source->MappedLength);
+    } else {
+        free((void*)source->Data);
+    }
+    free(source);
+}
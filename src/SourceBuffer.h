@@ -0,0 +1,32 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include "Common.h"
+
+/*
+    Read-only contents of a source file. `Data[Length]` is always a readable '\0' sentinel, but the contents may
+    contain NUL bytes themselves, so consumers should bound their scans by `Length`.
+*/
+typedef struct SourceBuffer {
+    const char* Path;
+    const char* Data;
+    size_t Length;
+    // Size of the mapping when the file is memory-mapped, 0 when it was read into the heap.
+    size_t MappedLength;
+} SourceBuffer;
+
+/*
+    Open a source file. Large files are memory-mapped without copying; small files are read with a single read.
+
+    Returns NULL on failure.
+*/
+SourceBuffer* openSourceBuffer(const char* filepath);
+
+/*
+    Unmap or free a source buffer. Pointers into its data become invalid.
+
+    Does nothing when source is NULL.
+*/
+void freeSourceBuffer(SourceBuffer* source);
+
+#endif
@@ -1,56 +1,24 @@
 #include "Statement.h"
 #include "Expression.h"
-#include "Statement.h"
-#include "StretchyBuffer.h"
-#include <stdlib.h>
-
-static Statement* newStatement(StatementType type) {
-    Statement* statement = calloc(1, sizeof(Statement));
-    statement->Type = type;
-    return statement;
-}
-
-Statement* newExpressionStatement(Expression* expression) {
-    Statement* expressionStatement = newStatement(STATEMENT_EXPRESSION);
-    expressionStatement->Expresssion = expression;
-    return expressionStatement;
-}
-Statement* newDeclarationStatement(Declaration* declaration) {
-    Statement* declarationStatement = newStatement(STATEMENT_DECLARATION);
-    declarationStatement->Declaration = declaration;
-    return declarationStatement;
-}
-
-Statement* newStatementBlock() {
-    Statement* statementBlock = newStatement(STATEMENT_BLOCK);
-    statementBlock->Block = calloc(1, sizeof(StatementBlock));
-    statementBlock->Block->Statements = newStretchyBuffer(sizeof(Statement*));
-    return statementBlock;
-}
+#include "Ast.h"
 
-Statement* newIfStatement(Expression* condition, Statement* block, Statement* elseBlock) {
-    Statement* ifStatement = newStatement(STATEMENT_IF);
-    ifStatement->If.Condition = condition;
-    ifStatement->If.Block = block;
-    ifStatement->If.ElseBlock = elseBlock;
-    return ifStatement;
+NodeIndex newExpressionStatement(Ast* ast, NodeIndex expression) {
+    return addNode(ast, NODE_EXPRESSION_STATEMENT, expression, 0);
 }
 
-Statement* newReturnStatement(Expression* expression) {
-    Statement* returnStatement = newStatement(STATEMENT_RETURN);
-    returnStatement->Expresssion = expression;
-    return returnStatement;
+NodeIndex newStatementBlock(Ast* ast, const NodeIndex* statements, uint32_t count) {
+    return addNode(ast, NODE_BLOCK, addExtra(ast, statements, count), count);
 }
 
-void addStatement(StatementBlock* statementBlock, Statement* statement) {
-    statementBlock->Count += 1;
-    bufferPush(statementBlock->Statements, statement);
+NodeIndex newLazyBlock(Ast* ast, uint32_t startToken, uint32_t endToken) {
+    return addNode(ast, NODE_LAZY_BLOCK, startToken, endToken);
 }
 
-void addExpression(StatementBlock* statementBlock, Expression* expression) {
-    addStatement(statementBlock, newExpressionStatement(expression));
+NodeIndex newIfStatement(Ast* ast, NodeIndex condition, NodeIndex block, NodeIndex elseBlock) {
+    NodeIndex blocks[] = { block, elseBlock };
+    return addNode(ast, NODE_IF, condition, addExtra(ast, blocks, 2));
 }
 
-void addDeclaration(StatementBlock* statementBlock, Declaration* declaration) {
-    addStatement(statementBlock, newDeclarationStatement(declaration));
+NodeIndex newReturnStatement(Ast* ast, NodeIndex expression) {
+    return addNode(ast, NODE_RETURN, expression, 0);
 }
@@ -4,46 +4,25 @@
 #include "Expression.h"
 #include "Declaration.h"
 
-typedef struct Statement Statement;
-typedef enum StatementType {
-    STATEMENT_UNKNOWN,
-    STATEMENT_EXPRESSION,
-    STATEMENT_DECLARATION,
-    STATEMENT_BLOCK,
-    STATEMENT_IF,
-    STATEMENT_RETURN
-} StatementType;
-
-typedef struct StatementBlock {
-    size_t Count;
-    Statement** Statements;
-} StatementBlock;
-
-typedef struct IfStatement {
-    Expression* Condition;
-    Statement* Block;
-    Statement* ElseBlock;
-} IfStatement;
-
-struct Statement {
-    StatementType Type;
-    union {
-        Expression* Expresssion;
-        Declaration* Declaration;
-        StatementBlock* Block;
-        IfStatement If;
-    };
-};
-
-Statement* newExpressionStatement(Expression* expression);
-Statement* newDeclarationStatement(Declaration* declaration);
-Statement* newIfStatement(Expression* condition, Statement* block, Statement* elseBlock);
-Statement* newReturnStatement(Expression* expression);
-
-Statement* newStatementBlock();
-void addStatement(StatementBlock* statementBlock, Statement* statement);
-void addExpression(StatementBlock* statementBlock, Expression* expression);
-void addDeclaration(StatementBlock* statementBlock, Declaration* declaration);
-
+NodeIndex newExpressionStatement(Ast* ast, NodeIndex expression);
+NodeIndex newIfStatement(Ast* ast, NodeIndex condition, NodeIndex block, NodeIndex elseBlock);
+NodeIndex newReturnStatement(Ast* ast, NodeIndex expression);
+
+/*
+    Create a block over `count` statements, which are copied into the tree's extra data.
+*/
+NodeIndex newStatementBlock(Ast* ast, const NodeIndex* statements, uint32_t count);
+
+/*
+    Create a placeholder for a block whose tokens [startToken, endToken) were skipped rather than parsed.
+*/
+NodeIndex newLazyBlock(Ast* ast, uint32_t startToken, uint32_t endToken);
+
+#define blockStatements(ast, node) ((ast)->Extra + (ast)->First[node])
+#define blockCount(ast, node) ((ast)->Second[node])
+#define lazyBlockStart(ast, node) ((ast)->First[node])
+#define lazyBlockEnd(ast, node) ((ast)->Second[node])
+#define ifBlock(ast, node) (nodeExtra(ast, node)[0])
+#define ifElseBlock(ast, node) (nodeExtra(ast, node)[1])
 
 #endif
\ No newline at end of file
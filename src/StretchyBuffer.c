@@ -24,16 +24,12 @@ void* stretchyBufferGrow(void* buffer, size_t elementSize) {
     if (!buffer || !elementSize) return NULL;
     StretchyBuffer* stretchyBuffer = stretchyBufferHeader(buffer);
 
-    size_t length = stretchyBuffer->Length;
     size_t newCapacity = stretchyBuffer->Capacity * 1.5;
-    StretchyBuffer* newBuffer = calloc(1, sizeof(StretchyBuffer) + newCapacity * elementSize);
+    // realloc can often extend in place, or remap large buffers, instead of copying every element.
+    StretchyBuffer* newBuffer = realloc(stretchyBuffer, sizeof(StretchyBuffer) + newCapacity * elementSize);
     if (!newBuffer) return NULL;
 
-    newBuffer->Length = length;
     newBuffer->Capacity = newCapacity;
-    memcpy(newBuffer->Buffer, stretchyBuffer->Buffer, length * elementSize);
-
-    free(stretchyBuffer);
     return newBuffer->Buffer;
 }
 
@@ -0,0 +1,122 @@
+#include "Symbol.h"
+#include "Arena.h"
+#include "StretchyBuffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_TABLE_CAPACITY 1024
+
+typedef struct SymbolEntry {
+    const char* Name;
+    uint32_t Length;
+    uint32_t Hash;
+} SymbolEntry;
+
+/*
+    Entries are indexed by symbol; the hash table maps hashes to symbols with open addressing and linear probing.
+    Slot value 0 is free, which lines up with SYMBOL_NONE never being handed out.
+*/
+static struct {
+    Arena* Strings;
+    SymbolEntry* Entries;
+    Symbol* Table;
+    uint32_t TableCapacity;
+} symbols;
+
+uint32_t hashSymbolName(const char* string, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)string[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void initializeSymbols(void) {
+    symbols.Strings = newArena(ARENA_DEFAULT_CHUNK_SIZE);
+    symbols.Entries = newStretchyBuffer(sizeof(SymbolEntry));
+    bufferPush(symbols.Entries, ((SymbolEntry) { .Name = "", .Length = 0, .Hash = 0 }));
+    symbols.TableCapacity = INITIAL_TABLE_CAPACITY;
+    symbols.Table = calloc(symbols.TableCapacity, sizeof(Symbol));
+}
+
+static void growTable(void) {
+    uint32_t capacity = symbols.TableCapacity * 2;
+    Symbol* table = calloc(capacity, sizeof(Symbol));
+    uint32_t mask = capacity - 1;
+
+    for (Symbol symbol = 1; symbol < bufferLength(symbols.Entries); symbol++) {
+        uint32_t slot = symbols.Entries[symbol].Hash & mask;
+        while (table[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = symbol;
+    }
+
+    free(symbols.Table);
+    symbols.Table = table;
+    symbols.TableCapacity = capacity;
+}
+
+Symbol intern(const char* string, size_t length) {
+    return internHashed(string, length, hashSymbolName(string, length));
+}
+
+Symbol internHashed(const char* string, size_t length, uint32_t hash) {
+    if (!symbols.Table) {
+        initializeSymbols();
+    }
+
+    uint32_t mask = symbols.TableCapacity - 1;
+    uint32_t slot = hash & mask;
+    while (symbols.Table[slot]) {
+        Symbol symbol = symbols.Table[slot];
+        SymbolEntry* entry = &symbols.Entries[symbol];
+        if (entry->Hash == hash && entry->Length == length && memcmp(entry->Name, string, length) == 0) {
+            return symbol;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    char* name = arenaAllocate(symbols.Strings, length + 1);
+    memcpy(name, string, length);
+
+    Symbol symbol = bufferLength(symbols.Entries);
+    bufferPush(symbols.Entries, ((SymbolEntry) { .Name = name, .Length = length, .Hash = hash }));
+    symbols.Table[slot] = symbol;
+
+    // Keep the load factor under 1/2 so probe sequences stay short.
+    if (bufferLength(symbols.Entries) * 2 > symbols.TableCapacity) {
+        growTable();
+    }
+
+    return symbol;
+}
+
+const char* symbolName(Symbol symbol) {
+    // SYMBOL_NONE names the empty string even before anything is interned.
+    return symbol != SYMBOL_NONE ? symbols.Entries[symbol].Name : "";
+}
+
+size_t symbolLength(Symbol symbol) {
+    return symbol != SYMBOL_NONE ? symbols.Entries[symbol].Length : 0;
+}
+
+void freeSymbols(void) {
+    if (!symbols.Table) return;
+
+    freeArena(symbols.Strings);
+    freeStretchyBuffer(symbols.Entries);
+    free(symbols.Table);
+    memset(&symbols, 0, sizeof(symbols));
+}
+
+uint32_t symbolCount(void) {
+    return symbols.Entries ? bufferLength(symbols.Entries) : 1;
+}
+
+void printSymbolStatistics(FILE* stream) {
+    size_t count = symbols.Entries ? bufferLength(symbols.Entries) - 1 : 0;
+    size_t bytes = symbols.Strings ? symbols.Strings->BytesAllocated : 0;
+    fprintf(stream, "Symbols: %zu distinct, %zu bytes of names\n", count, bytes);
+}
@@ -0,0 +1,45 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include "Common.h"
+#include <stdio.h>
+
+/*
+    An interned string. Equal strings always intern to the same symbol, so names can be compared as integers.
+    Symbol 0 is never handed out and marks the absence of a name.
+*/
+typedef uint32_t Symbol;
+
+#define SYMBOL_NONE ((Symbol)0)
+
+/*
+    Intern `length` bytes of `string` and return its symbol. The string doesn't need to be NUL-terminated.
+*/
+Symbol intern(const char* string, size_t length);
+
+/*
+    Intern a string whose hash was already computed with hashSymbolName, possibly on another thread. Interning
+    itself isn't thread-safe.
+*/
+Symbol internHashed(const char* string, size_t length, uint32_t hash);
+uint32_t hashSymbolName(const char* string, size_t length);
+
+/*
+    Get the canonical, NUL-terminated spelling of a symbol. It stays valid until freeSymbols is called.
+*/
+const char* symbolName(Symbol symbol);
+size_t symbolLength(Symbol symbol);
+
+/*
+    Every symbol handed out so far is below this number.
+*/
+uint32_t symbolCount(void);
+
+/*
+    Release every interned string. All previously returned symbols become invalid.
+*/
+void freeSymbols(void);
+
+void printSymbolStatistics(FILE* stream);
+
+#endif
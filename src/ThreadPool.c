@@ -0,0 +1,98 @@
+#define _GNU_SOURCE
+#include "ThreadPool.h"
+#include "StretchyBuffer.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void* runWorker(void* argument) {
+    ThreadPool* pool = argument;
+
+    pthread_mutex_lock(&pool->Lock);
+    while (true) {
+        while (pool->NextTask == bufferLength(pool->Tasks) && !pool->Stopping) {
+            pthread_cond_wait(&pool->TaskAvailable, &pool->Lock);
+        }
+        if (pool->NextTask == bufferLength(pool->Tasks)) {
+            break;
+        }
+
+        Task task = pool->Tasks[pool->NextTask++];
+        pthread_mutex_unlock(&pool->Lock);
+        task.Function(task.Argument);
+        pthread_mutex_lock(&pool->Lock);
+
+        if (--pool->PendingTasks == 0) {
+            pthread_cond_broadcast(&pool->TasksDone);
+        }
+    }
+    pthread_mutex_unlock(&pool->Lock);
+    return NULL;
+}
+
+ThreadPool* newThreadPool(uint32_t threadCount) {
+    ThreadPool* pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->Threads = calloc(threadCount, sizeof(pthread_t));
+    pool->Tasks = newStretchyBuffer(sizeof(Task));
+    pthread_mutex_init(&pool->Lock, NULL);
+    pthread_cond_init(&pool->TaskAvailable, NULL);
+    pthread_cond_init(&pool->TasksDone, NULL);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        if (pthread_create(&pool->Threads[i], NULL, runWorker, pool) != 0) {
+            freeThreadPool(pool);
+            return NULL;
+        }
+        pool->ThreadCount++;
+    }
+
+    return pool;
+}
+
+void freeThreadPool(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->Lock);
+    pool->Stopping = true;
+    pthread_cond_broadcast(&pool->TaskAvailable);
+    pthread_mutex_unlock(&pool->Lock);
+    for (uint32_t i = 0; i < pool->ThreadCount; i++) {
+        pthread_join(pool->Threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->TasksDone);
+    pthread_cond_destroy(&pool->TaskAvailable);
+    pthread_mutex_destroy(&pool->Lock);
+    freeStretchyBuffer(pool->Tasks);
+    free(pool->Threads);
+    free(pool);
+}
+
+void submitTask(ThreadPool* pool, TaskFunction function, void* argument) {
+    pthread_mutex_lock(&pool->Lock);
+    bufferPush(pool->Tasks, ((Task) { .Function = function, .Argument = argument }));
+    pool->PendingTasks++;
+    pthread_cond_signal(&pool->TaskAvailable);
+    pthread_mutex_unlock(&pool->Lock);
+}
+
+void waitForTasks(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->Lock);
+    while (pool->PendingTasks > 0) {
+        pthread_cond_wait(&pool->TasksDone, &pool->Lock);
+    }
+    // Every queued task has been taken, so the queue can start over.
+    bufferLength(pool->Tasks) = 0;
+    pool->NextTask = 0;
+    pthread_mutex_unlock(&pool->Lock);
+}
+
+uint32_t processorCount(void) {
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return CPU_COUNT(&set);
+    }
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+}
@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "Common.h"
+#include <pthread.h>
+
+typedef void (*TaskFunction)(void* argument);
+
+typedef struct Task {
+    TaskFunction Function;
+    void* Argument;
+} Task;
+
+/*
+    A fixed set of worker threads running submitted tasks in submission order. Tasks are batched: submit a group of
+    independent tasks, then wait for all of them before using their results.
+*/
+typedef struct ThreadPool {
+    pthread_t* Threads;
+    uint32_t ThreadCount;
+
+    pthread_mutex_t Lock;
+    pthread_cond_t TaskAvailable;
+    pthread_cond_t TasksDone;
+    Task* Tasks;
+    size_t NextTask;
+    size_t PendingTasks;
+    bool Stopping;
+} ThreadPool;
+
+/*
+    Start a pool of `threadCount` workers.
+
+    Returns NULL on failure.
+*/
+ThreadPool* newThreadPool(uint32_t threadCount);
+
+/*
+    Stop the workers once the queued tasks have run and free the pool.
+
+    Does nothing when pool is NULL.
+*/
+void freeThreadPool(ThreadPool* pool);
+
+void submitTask(ThreadPool* pool, TaskFunction function, void* argument);
+
+/*
+    Block until every submitted task has finished.
+*/
+void waitForTasks(ThreadPool* pool);
+
+/*
+    Number of CPUs available to the process, at least 1.
+*/
+uint32_t processorCount(void);
+
+#endif
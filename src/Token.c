@@ -1,4 +1,5 @@
 #include "Token.h"
+#include <stdlib.h>
 
 const char* TOKEN_TO_STRING[] = {
     #define TOKEN(t) [TOKEN_##t] = #t,
@@ -6,12 +7,135 @@ const char* TOKEN_TO_STRING[] = {
     #undef TOKEN
 };
 
-Token createToken(TokenType type, const char* lexeme, size_t length, int line, int column) {
-    return (Token) {
-        .Type = type,
-        .Lexeme = lexeme,
-        .Length = length,
-        .Line = line,
-        .Column = column
-    };
-}
\ No newline at end of file
+_Static_assert(KIND_COUNT <= UINT8_MAX + 1, "token kinds are stored in one byte");
+
+const uint8_t TOKEN_KIND_TYPE[KIND_COUNT] = {
+    [KIND_NONE] = TOKEN_UNKNOWN,
+    [KIND_IDENTIFIER] = TOKEN_IDENTIFIER,
+    [KIND_INTEGER] = TOKEN_INTEGER,
+    [KIND_REAL] = TOKEN_REAL,
+    [KIND_STRING] = TOKEN_STRING,
+    [KIND_EOF] = TOKEN_EOF,
+    #define KEYWORD(k, _) [KEYWORD_##k] = TOKEN_KEYWORD,
+    KEYWORDS
+    #undef KEYWORD
+    #define PUNCTUATOR(p, _) [PUNCTUATOR_##p] = TOKEN_PUNCTUATOR,
+    PUNCTUATORS
+    #undef PUNCTUATOR
+};
+
+const char* TOKEN_KIND_TO_STRING[KIND_COUNT] = {
+    #define KEYWORD(k, s) [KEYWORD_##k] = s,
+    KEYWORDS
+    #undef KEYWORD
+    #define PUNCTUATOR(p, s) [PUNCTUATOR_##p] = s,
+    PUNCTUATORS
+    #undef PUNCTUATOR
+};
+
+const uint8_t TOKEN_KIND_LENGTH[KIND_COUNT] = {
+    #define KEYWORD(k, s) [KEYWORD_##k] = sizeof(s) - 1,
+    KEYWORDS
+    #undef KEYWORD
+    #define PUNCTUATOR(p, s) [PUNCTUATOR_##p] = sizeof(s) - 1,
+    PUNCTUATORS
+    #undef PUNCTUATOR
+};
+
+static TokenStream* allocateTokenStream(const char* source, uint32_t capacity, uint32_t literalCapacity, uint32_t mask) {
+    TokenStream* tokens = calloc(1, sizeof(TokenStream));
+    if (!tokens) return NULL;
+
+    tokens->Source = source;
+    tokens->Capacity = capacity;
+    tokens->LiteralCapacity = literalCapacity;
+    tokens->Mask = mask;
+    tokens->Kinds = malloc(capacity * sizeof(uint8_t));
+    tokens->Offsets = malloc(capacity * sizeof(uint32_t));
+    tokens->Lengths = malloc(capacity * sizeof(uint32_t));
+    tokens->Values = malloc(capacity * sizeof(uint32_t));
+    tokens->Literals = malloc(literalCapacity * sizeof(uint64_t));
+    if (!tokens->Kinds || !tokens->Offsets || !tokens->Lengths || !tokens->Values || !tokens->Literals) {
+        freeTokenStream(tokens);
+        return NULL;
+    }
+
+    return tokens;
+}
+
+TokenStream* newTokenStream(const char* source, uint32_t capacity) {
+    capacity = capacity > 16 ? capacity : 16;
+    return allocateTokenStream(source, capacity, capacity / 8 + 16, UINT32_MAX);
+}
+
+TokenStream* newTokenRing(const char* source, uint32_t capacity) {
+    uint32_t ringCapacity = 16;
+    while (ringCapacity < capacity) {
+        ringCapacity *= 2;
+    }
+    // A ring never holds more literals than tokens, so literals can wrap with the same mask.
+    return allocateTokenStream(source, ringCapacity, ringCapacity, ringCapacity - 1);
+}
+
+void freeTokenStream(TokenStream* tokens) {
+    if (!tokens) return;
+    free(tokens->Kinds);
+    free(tokens->Offsets);
+    free(tokens->Lengths);
+    free(tokens->Values);
+    free(tokens->Literals);
+    free(tokens);
+}
+
+static void resizeTokenStream(TokenStream* tokens) {
+    tokens->Kinds = realloc(tokens->Kinds, tokens->Capacity * sizeof(uint8_t));
+    tokens->Offsets = realloc(tokens->Offsets, tokens->Capacity * sizeof(uint32_t));
+    tokens->Lengths = realloc(tokens->Lengths, tokens->Capacity * sizeof(uint32_t));
+    tokens->Values = realloc(tokens->Values, tokens->Capacity * sizeof(uint32_t));
+}
+
+static void growTokenStream(TokenStream* tokens) {
+    tokens->Capacity += tokens->Capacity / 2;
+    resizeTokenStream(tokens);
+}
+
+void reserveTokenStream(TokenStream* tokens, uint32_t capacity, uint32_t literalCapacity) {
+    if (capacity > tokens->Capacity) {
+        tokens->Capacity = capacity;
+        resizeTokenStream(tokens);
+    }
+    if (literalCapacity > tokens->LiteralCapacity) {
+        tokens->LiteralCapacity = literalCapacity;
+        tokens->Literals = realloc(tokens->Literals, tokens->LiteralCapacity * sizeof(uint64_t));
+    }
+}
+
+TokenIndex pushToken(TokenStream* tokens, TokenKind kind, uint32_t offset, uint32_t length, uint32_t value) {
+    if (tokens->Count == tokens->Capacity && !isTokenRing(tokens)) {
+        growTokenStream(tokens);
+    }
+
+    TokenIndex index = tokens->Count++;
+    uint32_t slot = index & tokens->Mask;
+    tokens->Kinds[slot] = kind;
+    tokens->Offsets[slot] = offset;
+    tokens->Lengths[slot] = length;
+    tokens->Values[slot] = value;
+    return index;
+}
+
+uint32_t pushLiteral(TokenStream* tokens, uint64_t bits) {
+    if (tokens->LiteralCount == tokens->LiteralCapacity && !isTokenRing(tokens)) {
+        tokens->LiteralCapacity += tokens->LiteralCapacity / 2;
+        tokens->Literals = realloc(tokens->Literals, tokens->LiteralCapacity * sizeof(uint64_t));
+    }
+
+    uint32_t slot = tokens->LiteralCount++ & tokens->Mask;
+    tokens->Literals[slot] = bits;
+    return slot;
+}
+
+size_t tokenStreamSize(TokenStream* tokens) {
+    size_t perToken = sizeof(uint8_t) + 3 * sizeof(uint32_t);
+    return tokens->Capacity * perToken + tokens->LiteralCapacity * sizeof(uint64_t);
+}
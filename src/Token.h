@@ -2,6 +2,7 @@
 #define TOKEN_H
 
 #include "Common.h"
+#include "Symbol.h"
 
 #define TOKENS \
         TOKEN(UNKNOWN) \
@@ -19,21 +20,206 @@ typedef enum TokenType {
     #undef TOKEN
 } TokenType;
 
-typedef struct Token {
-    TokenType Type;
-    const char* Lexeme;
-    size_t Length;
-    int Line, Column;
-    union {
-        uint64_t Integer;
-        double Real;
-        const char* String;
-        char* Name;
-    };
-} Token;
+#define KEYWORDS \
+        KEYWORD(ANY, "any") \
+        KEYWORD(AS, "as") \
+        KEYWORD(BOOL, "bool") \
+        KEYWORD(BREAK, "break") \
+        KEYWORD(CASE, "case") \
+        KEYWORD(CHAR, "char") \
+        KEYWORD(CLASS, "class") \
+        KEYWORD(CONST, "const") \
+        KEYWORD(CONTINUE, "continue") \
+        KEYWORD(DEFAULT, "default") \
+        KEYWORD(DO, "do") \
+        KEYWORD(DOUBLE, "double") \
+        KEYWORD(ELSE, "else") \
+        KEYWORD(ENUM, "enum") \
+        KEYWORD(FALSE, "false") \
+        KEYWORD(FLOAT, "float") \
+        KEYWORD(FOR, "for") \
+        KEYWORD(FUNCTION, "function") \
+        KEYWORD(GOTO, "goto") \
+        KEYWORD(IF, "if") \
+        KEYWORD(IMPORT, "import") \
+        KEYWORD(INLINE, "inline") \
+        KEYWORD(INT, "int") \
+        KEYWORD(LET, "let") \
+        KEYWORD(NAMESPACE, "namespace") \
+        KEYWORD(NULL, "null") \
+        KEYWORD(PRIVATE, "private") \
+        KEYWORD(PROTECTED, "protected") \
+        KEYWORD(PUBLIC, "public") \
+        KEYWORD(RETURN, "return") \
+        KEYWORD(SHORT, "short") \
+        KEYWORD(SIGNED, "signed") \
+        KEYWORD(SIZEOF, "sizeof") \
+        KEYWORD(STATIC, "static") \
+        KEYWORD(STRING, "string") \
+        KEYWORD(STRUCT, "struct") \
+        KEYWORD(SWITCH, "switch") \
+        KEYWORD(THIS, "this") \
+        KEYWORD(TRUE, "true") \
+        KEYWORD(TYPEOF, "typeof") \
+        KEYWORD(UNION, "union") \
+        KEYWORD(UNSIGNED, "unsigned") \
+        KEYWORD(VOID, "void") \
+        KEYWORD(WHILE, "while") \
+
+#define PUNCTUATORS \
+        PUNCTUATOR(EXCLAMATION, "!") \
+        PUNCTUATOR(HASH, "#") \
+        PUNCTUATOR(DOLLAR, "$") \
+        PUNCTUATOR(PERCENT, "%") \
+        PUNCTUATOR(AMPERSAND, "&") \
+        PUNCTUATOR(APOSTROPHE, "'") \
+        PUNCTUATOR(LEFT_PARENTHESIS, "(") \
+        PUNCTUATOR(RIGHT_PARENTHESIS, ")") \
+        PUNCTUATOR(ASTERISK, "*") \
+        PUNCTUATOR(PLUS, "+") \
+        PUNCTUATOR(COMMA, ",") \
+        PUNCTUATOR(MINUS, "-") \
+        PUNCTUATOR(DOT, ".") \
+        PUNCTUATOR(SLASH, "/") \
+        PUNCTUATOR(COLON, ":") \
+        PUNCTUATOR(SEMICOLON, ";") \
+        PUNCTUATOR(LESS, "<") \
+        PUNCTUATOR(EQUAL, "=") \
+        PUNCTUATOR(GREATER, ">") \
+        PUNCTUATOR(QUESTION, "?") \
+        PUNCTUATOR(AT, "@") \
+        PUNCTUATOR(LEFT_BRACKET, "[") \
+        PUNCTUATOR(BACKSLASH, "\\") \
+        PUNCTUATOR(RIGHT_BRACKET, "]") \
+        PUNCTUATOR(CARET, "^") \
+        PUNCTUATOR(UNDERSCORE, "_") \
+        PUNCTUATOR(BACKTICK, "`") \
+        PUNCTUATOR(LEFT_BRACE, "{") \
+        PUNCTUATOR(PIPE, "|") \
+        PUNCTUATOR(RIGHT_BRACE, "}") \
+        PUNCTUATOR(TILDE, "~") \
+        PUNCTUATOR(ARROW, "->") \
+        PUNCTUATOR(PLUS_PLUS, "++") \
+        PUNCTUATOR(MINUS_MINUS, "--") \
+        PUNCTUATOR(SHIFT_RIGHT, ">>") \
+        PUNCTUATOR(SHIFT_LEFT, "<<") \
+        PUNCTUATOR(LESS_EQUAL, "<=") \
+        PUNCTUATOR(GREATER_EQUAL, ">=") \
+        PUNCTUATOR(EQUAL_EQUAL, "==") \
+        PUNCTUATOR(NOT_EQUAL, "!=") \
+        PUNCTUATOR(LOGICAL_AND, "&&") \
+        PUNCTUATOR(LOGICAL_OR, "||") \
+        PUNCTUATOR(ASTERISK_EQUAL, "*=") \
+        PUNCTUATOR(SLASH_EQUAL, "/=") \
+        PUNCTUATOR(PERCENT_EQUAL, "%=") \
+        PUNCTUATOR(PLUS_EQUAL, "+=") \
+        PUNCTUATOR(MINUS_EQUAL, "-=") \
+        PUNCTUATOR(SHIFT_LEFT_EQUAL, "<<=") \
+        PUNCTUATOR(SHIFT_RIGHT_EQUAL, ">>=") \
+        PUNCTUATOR(AMPERSAND_EQUAL, "&=") \
+        PUNCTUATOR(CARET_EQUAL, "^=") \
+        PUNCTUATOR(PIPE_EQUAL, "|=") \
+        PUNCTUATOR(ELLIPSIS, "...") \
+
+/*
+    The specific kind of a token, with one value per keyword and per punctuator, so the parser can decide everything
+    with integer compares. Keyword and punctuator kinds keep their KEYWORD_ and PUNCTUATOR_ prefixes.
+*/
+typedef enum TokenKind {
+    KIND_NONE,
+    KIND_IDENTIFIER,
+    KIND_INTEGER,
+    KIND_REAL,
+    KIND_STRING,
+    KIND_EOF,
+    #define KEYWORD(k, _) KEYWORD_##k,
+    KEYWORDS
+    #undef KEYWORD
+    #define PUNCTUATOR(p, _) PUNCTUATOR_##p,
+    PUNCTUATORS
+    #undef PUNCTUATOR
+    KIND_COUNT
+} TokenKind;
+
+typedef uint32_t TokenIndex;
+
+/*
+    Tokens of a source stored as parallel arrays, so scanning the kinds touches one byte per token. Lexemes aren't
+    stored: a token's text is `Source + Offsets[i]` for `Lengths[i]` bytes.
+
+    Values holds the Symbol of identifiers and strings (their contents without quotes), and for integers and reals
+    the index of their value in Literals.
+
+    A stream is either a growing array of all tokens, or a ring of a fixed power-of-two capacity that only keeps the
+    last `Capacity` tokens pushed. Indices are absolute in both cases and are wrapped with Mask on access.
+*/
+typedef struct TokenStream {
+    const char* Source;
+    uint8_t* Kinds;
+    uint32_t* Offsets;
+    uint32_t* Lengths;
+    uint32_t* Values;
+    uint64_t* Literals;
+    // Number of tokens pushed so far.
+    uint32_t Count;
+    uint32_t Capacity;
+    uint32_t LiteralCount;
+    uint32_t LiteralCapacity;
+    // Capacity - 1 for rings, all ones otherwise.
+    uint32_t Mask;
+} TokenStream;
 
 extern const char* TOKEN_TO_STRING[];
+// General type of each kind.
+extern const uint8_t TOKEN_KIND_TYPE[];
+// Spelling and length of keyword and punctuator kinds; NULL and 0 for the others.
+extern const char* TOKEN_KIND_TO_STRING[];
+extern const uint8_t TOKEN_KIND_LENGTH[];
+
+/*
+    Create an empty token stream over `source` with room for `capacity` tokens.
+
+    Returns NULL on failure.
+*/
+TokenStream* newTokenStream(const char* source, uint32_t capacity);
+
+/*
+    Create an empty token ring over `source` that keeps the last `capacity` tokens, rounded up to a power of two.
+    Pushing never allocates; the caller must not push more than `capacity` tokens past the oldest one still in use.
+
+    Returns NULL on failure.
+*/
+TokenStream* newTokenRing(const char* source, uint32_t capacity);
+void freeTokenStream(TokenStream* tokens);
+
+#define isTokenRing(tokens) ((tokens)->Mask != UINT32_MAX)
+
+/*
+    Make room for at least `capacity` tokens and `literalCapacity` literals in a stream that isn't a ring.
+*/
+void reserveTokenStream(TokenStream* tokens, uint32_t capacity, uint32_t literalCapacity);
+
+/*
+    Append a token and return its index.
+*/
+TokenIndex pushToken(TokenStream* tokens, TokenKind kind, uint32_t offset, uint32_t length, uint32_t value);
+
+/*
+    Store the bits of an integer or real literal and return the value to push with its token.
+*/
+uint32_t pushLiteral(TokenStream* tokens, uint64_t bits);
+
+/*
+    Size of the stream's arrays in bytes.
+*/
+size_t tokenStreamSize(TokenStream* tokens);
 
-Token createToken(TokenType type, const char* lexeme, size_t length, int line, int column);
+#define tokenKind(tokens, index) ((TokenKind)(tokens)->Kinds[(index) & (tokens)->Mask])
+#define tokenType(tokens, index) ((TokenType)TOKEN_KIND_TYPE[tokenKind(tokens, index)])
+#define tokenOffset(tokens, index) ((tokens)->Offsets[(index) & (tokens)->Mask])
+#define tokenLength(tokens, index) ((tokens)->Lengths[(index) & (tokens)->Mask])
+#define tokenLexeme(tokens, index) ((tokens)->Source + tokenOffset(tokens, index))
+#define tokenSymbol(tokens, index) ((Symbol)(tokens)->Values[(index) & (tokens)->Mask])
+#define tokenInteger(tokens, index) ((tokens)->Literals[(tokens)->Values[(index) & (tokens)->Mask]])
 
-#endif
\ No newline at end of file
+#endif
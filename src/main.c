@@ -1,27 +1,216 @@
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include "Common.h"
-#include "ReadFile.h"
+#include "SourceBuffer.h"
 #include "Lexer.h"
 #include "Parser.h"
 #include "Node.h"
 #include "Generator.h"
+#include "Ir.h"
+#include "Elf.h"
+#include "Cache.h"
+#include "Driver.h"
+#include "Symbol.h"
+#include "StretchyBuffer.h"
+#include "ScanKernels.h"
+#include "ThreadPool.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <stdarg.h>
+#include <signal.h>
 
 static const char* asmExtension = ".asm";
+// Tokens kept in flight when streaming them from the lexer into the parser.
+static const uint32_t streamingTokenCapacity = 4096;
 
 void usage(const char* programName);
 
-void sh(const char* command, ...) {
-    va_list args;
-    va_start(args, command);
+/*
+    Write the runtime on its own as an object, so programs compiled with -c can be linked against it.
+*/
+static int buildRuntime(const char* programName, const char* path) {
+    Generator* generator = newGenerator(EMITTER_MACHINE_CODE);
+    generateRuntime(generator);
+    bool written = writeObject(generator->Output, path);
+    if (!written) {
+        fprintf(stderr, "%s: could not write '%s'\n", programName, path);
+    }
+    freeGenerator(generator);
+    return written ? 0 : 1;
+}
 
-    const char* args = 0;
+/*
+    Link objects into an executable, with the runtime generated in place of runtime.o when `withRuntime` is set.
+*/
+static int linkObjects(const char* programName, const char* const* paths, size_t count, bool withRuntime, const char* path) {
+    Emitter* program = newEmitter(EMITTER_MACHINE_CODE, 64 * 1024);
+    int status = 0;
+    if (withRuntime) {
+        Generator* generator = newGenerator(EMITTER_MACHINE_CODE);
+        generateRuntime(generator);
+        emitEmitter(program, generator->Output);
+        freeGenerator(generator);
+    }
+    for (size_t i = 0; i < count; i++) {
+        Emitter* object = readObject(paths[i]);
+        if (!object) {
+            fprintf(stderr, "%s: could not read object '%s'\n", programName, paths[i]);
+            status = 1;
+            break;
+        }
+        emitEmitter(program, object);
+        freeEmitter(object);
+    }
 
-    execlp(command, command, args, NULL);
-    va_end(args);
+    const char* undefined = NULL;
+    if (status == 0 && !resolveSymbols(program, &undefined)) {
+        fprintf(stderr, "%s: undefined function '%s'\n", programName, undefined);
+        status = 1;
+    } else if (status == 0 && !writeExecutable(program, "_start", path)) {
+        fprintf(stderr, "%s: could not write '%s'\n", programName, path);
+        status = 1;
+    }
+    freeEmitter(program);
+    freeSymbols();
+    return status;
+}
+
+/*
+    Parse a byte count with an optional K, M or G suffix.
+
+    Returns false when `text` isn't one.
+*/
+static bool parseSize(const char* text, uint64_t* size) {
+    char* end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text) return false;
+
+    switch (*end) {
+        case 'G': value *= 1024; // fallthrough
+        case 'M': value *= 1024; // fallthrough
+        case 'K': value *= 1024; end++; break;
+        default: break;
+    }
+    *size = value;
+    return *end == '\0';
+}
+
+static int printCache(const char* programName, const char* directory, uint64_t limit) {
+    Cache* cache = openCache(directory, limit);
+    if (!cache) {
+        fprintf(stderr, "%s: could not open cache '%s'\n", programName, directory);
+        return 1;
+    }
+
+    trimCache(cache);
+    CacheStatistics statistics = cacheStatistics(cache);
+    uint64_t lookups = statistics.Hits + statistics.Misses;
+    printf("%llu entries, %.1f of %.1f MB, %llu hits, %llu misses (%.1f%% hit rate)\n",
+        (unsigned long long)statistics.Entries, statistics.Bytes / 1e6, cache->Limit / 1e6,
+        (unsigned long long)statistics.Hits, (unsigned long long)statistics.Misses,
+        lookups ? 100.0 * statistics.Hits / lookups : 0.0);
+    freeCache(cache);
+    return 0;
+}
+
+static int compareStrings(const void* left, const void* right) {
+    return strcmp(*(char* const*)left, *(char* const*)right);
+}
+
+/*
+    Build several inputs at once: each is compiled to an object by a compiler process of its own, up to `jobs` at a
+    time, and unless `path` is NULL the objects are linked with the runtime once all of them are done. Objects that
+    are linked go to a temporary directory and are deleted afterwards; with -c, each goes next to its source.
+*/
+static int buildProject(const char* programName, char** inputs, size_t count, const char* path, uint32_t jobs,
+    char** sharedOptions, bool printStatistics) {
+    char compiler[4096];
+    ssize_t compilerLength = readlink("/proc/self/exe", compiler, sizeof(compiler) - 1);
+    if (compilerLength <= 0) {
+        fprintf(stderr, "%s: could not find the compiler executable\n", programName);
+        return 1;
+    }
+    compiler[compilerLength] = '\0';
+
+    char* directory = NULL;
+    if (path) {
+        directory = makeTemporaryDirectory();
+        if (!directory) {
+            fprintf(stderr, "%s: could not create a directory for the objects\n", programName);
+            return 1;
+        }
+    }
+
+    uint64_t start = currentNanoseconds();
+    char** objects = calloc(count, sizeof(char*));
+    for (size_t i = 0; i < count; i++) {
+        if (directory) {
+            size_t length = strlen(directory) + 32;
+            objects[i] = malloc(length);
+            snprintf(objects[i], length, "%s/%zu.o", directory, i);
+        } else {
+            objects[i] = objectPathFor(inputs[i]);
+        }
+    }
+
+    // Inputs such as `a.nash` and `a` would write the same object.
+    bool collision = false;
+    if (!directory) {
+        char** sorted = malloc(count * sizeof(char*));
+        memcpy(sorted, objects, count * sizeof(char*));
+        qsort(sorted, count, sizeof(char*), compareStrings);
+        for (size_t i = 1; i < count && !collision; i++) {
+            if (streq(sorted[i - 1], sorted[i])) {
+                fprintf(stderr, "%s: several inputs would be compiled to '%s'\n", programName, sorted[i]);
+                collision = true;
+            }
+        }
+        free(sorted);
+    }
+
+    char*** commands = calloc(count, sizeof(char**));
+    for (size_t i = 0; i < count; i++) {
+        char** command = newStretchyBuffer(sizeof(char*));
+        char* fixed[] = { compiler, "build", inputs[i], "-c", "-o", objects[i] };
+        for (size_t j = 0; j < sizeof(fixed) / sizeof(fixed[0]); j++) {
+            bufferPush(command, fixed[j]);
+        }
+        for (size_t j = 0; j < bufferLength(sharedOptions); j++) {
+            bufferPush(command, sharedOptions[j]);
+        }
+        bufferPush(command, NULL);
+        commands[i] = command;
+    }
+
+    uint32_t failures = collision ? 0 : runProcesses(commands, count, jobs);
+    uint64_t compiled = currentNanoseconds();
+    int status = 1;
+    if (failures > 0) {
+        fprintf(stderr, "%s: %u of %zu inputs failed to build\n", programName, failures, count);
+    } else if (path) {
+        status = linkObjects(programName, (const char* const*)objects, count, true, path);
+    } else if (!collision) {
+        status = 0;
+    }
+    if (printStatistics) {
+        fprintf(stderr, "Compiling: %.3f ms, %zu inputs (%u jobs)\nLinking: %.3f ms\n",
+            (compiled - start) / 1e6, count, jobs, (currentNanoseconds() - compiled) / 1e6);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (directory) {
+            unlink(objects[i]);
+        }
+        freeStretchyBuffer(commands[i]);
+        free(objects[i]);
+    }
+    if (directory) {
+        rmdir(directory);
+    }
+    free(directory);
+    free(commands);
+    free(objects);
+    return status;
 }
 
 int main(int argc, const char* argv[]) {
@@ -33,49 +222,343 @@ int main(int argc, const char* argv[]) {
     const char** arguments = argv + 1;
     const size_t argumentCount = argc - 1;
     const char* inputFilePath = NULL;
+    char** inputPaths = newStretchyBuffer(sizeof(char*));
+    // Options passed on to the compiler processes of a multi-input build.
+    char** sharedOptions = newStretchyBuffer(sizeof(char*));
     const char* fileOutputPath = NULL;
+    bool dumpTokens = false;
     bool dumpAST = false;
+    bool dumpIR = false;
+    bool printStatistics = false;
+    bool streamTokens = false;
+    bool emitAssembly = false;
+    bool compileOnly = false;
+    bool writeRuntime = false;
+    bool building = false;
+    const char** objectPaths = NULL;
+    const char* cacheDirectory = NULL;
+    const char* assemblerCommand = NULL;
+    bool showCache = false;
+    uint64_t cacheLimit = CACHE_DEFAULT_LIMIT;
+    uint32_t threadCount = 1;
 
     for (int i = 0; i < argumentCount; i++) {
         const char* argument = arguments[i];
-        if (streq(argument, "ast")) {
-            inputFilePath = arguments[i + 1];
+        if (streq(argument, "tokens")) {
+            dumpTokens = true;
+        } else if (streq(argument, "ast")) {
             dumpAST = true;
-        } else if (streq(argument, "build")) {
-            inputFilePath = arguments[i + 1];
+        } else if (streq(argument, "ir")) {
+            dumpIR = true;
+        } else if (streq(argument, "build") && !building && !objectPaths) {
+            building = true;
+        } else if (streq(argument, "runtime")) {
+            writeRuntime = true;
+        } else if (streq(argument, "link") && !building && !objectPaths) {
+            objectPaths = newStretchyBuffer(sizeof(const char*));
+        } else if (streq(argument, "cache")) {
+            showCache = true;
+        } else if (streq(argument, "--cache") && i + 1 < argumentCount) {
+            cacheDirectory = arguments[++i];
+            bufferPush(sharedOptions, (char*)argument);
+            bufferPush(sharedOptions, (char*)arguments[i]);
+        } else if (streq(argument, "--cache-limit")) {
+            if (i + 1 >= argumentCount || !parseSize(arguments[++i], &cacheLimit)) {
+                fprintf(stderr, "%s: --cache-limit expects a size such as 512M\n", programName);
+                return 1;
+            }
+            bufferPush(sharedOptions, (char*)argument);
+            bufferPush(sharedOptions, (char*)arguments[i]);
+        } else if (streq(argument, "-c")) {
+            compileOnly = true;
         } else if (streq(argument, "-o")) {
-            fileOutputPath = arguments[i + 1];
+            fileOutputPath = arguments[++i];
+        } else if (streq(argument, "--stats")) {
+            printStatistics = true;
+        } else if (streq(argument, "-j")) {
+            threadCount = i + 1 < argumentCount ? atoi(arguments[++i]) : 0;
+            if (threadCount == 0) {
+                fprintf(stderr, "%s: -j expects a positive thread count\n", programName);
+                return 1;
+            }
+        } else if (streq(argument, "--stream")) {
+            streamTokens = true;
+        } else if (streq(argument, "--asm")) {
+            emitAssembly = true;
+        } else if (streq(argument, "--assembler") && i + 1 < argumentCount) {
+            assemblerCommand = arguments[++i];
+            emitAssembly = true;
+        } else if (strneq(argument, "--simd=", 7)) {
+            if (!selectScanKernels(argument + 7)) {
+                fprintf(stderr, "%s: unsupported scan kernels '%s'\n", programName, argument + 7);
+                return 1;
+            }
+            bufferPush(sharedOptions, (char*)argument);
+        } else if (argument[0] != '-' && building) {
+            // Options may come before, between or after the inputs; `@file` reads inputs from a manifest.
+            if (argument[0] == '@') {
+                if (!readManifest(argument + 1, &inputPaths)) {
+                    fprintf(stderr, "%s: could not read manifest '%s'\n", programName, argument + 1);
+                    return 1;
+                }
+            } else {
+                bufferPush(inputPaths, strdup(argument));
+            }
+        } else if (argument[0] != '-' && objectPaths) {
+            bufferPush(objectPaths, argument);
+        } else if (argument[0] != '-' && (dumpTokens || dumpAST || dumpIR) && !inputFilePath) {
+            inputFilePath = argument;
+        } else if (argument[0] != '-' && showCache && !cacheDirectory) {
+            cacheDirectory = argument;
         }
     }
+    if (building) {
+        inputFilePath = bufferLength(inputPaths) > 0 ? inputPaths[0] : NULL;
+    }
     if (!fileOutputPath) {
-        fileOutputPath = "output";
+        fileOutputPath = writeRuntime ? "runtime.o" : "output";
     }
+    if (writeRuntime) {
+        return buildRuntime(programName, fileOutputPath);
+    }
+    if (objectPaths) {
+        int status = linkObjects(programName, objectPaths, bufferLength(objectPaths), false, fileOutputPath);
+        freeStretchyBuffer(objectPaths);
+        return status;
+    }
+    if (bufferLength(inputPaths) > 1 && (dumpTokens || dumpAST || dumpIR || emitAssembly)) {
+        fprintf(stderr, "%s: only executables and objects can be built from several inputs\n", programName);
+        return 1;
+    }
+    if (bufferLength(inputPaths) > 1) {
+        // With several inputs, -j counts compiler processes rather than threads within one. With -c, every input
+        // gets its own object and nothing is linked.
+        int status = buildProject(programName, inputPaths, bufferLength(inputPaths), compileOnly ? NULL : fileOutputPath,
+            threadCount, sharedOptions, printStatistics);
+        for (size_t i = 0; i < bufferLength(inputPaths); i++) {
+            free(inputPaths[i]);
+        }
+        freeStretchyBuffer(inputPaths);
+        freeStretchyBuffer(sharedOptions);
+        return status;
+    }
+    if (showCache) {
+        return printCache(programName, cacheDirectory, cacheLimit);
+    }
+
+    SourceBuffer* source = openSourceBuffer(inputFilePath);
+    if (!source) {
+        fprintf(stderr, "%s: could not read '%s'\n", programName, inputFilePath);
+        return 1;
+    }
+
+    char* generatedAsmPath = NULL;
+    if (emitAssembly) {
+        generatedAsmPath = strcat(strcpy(calloc(strlen(fileOutputPath) + strlen(asmExtension) + 1, sizeof(char)), fileOutputPath), asmExtension);
+    }
+    const char* artifactPath = emitAssembly ? generatedAsmPath : fileOutputPath;
+
+    // A build whose source, compiler and output options were seen before copies the earlier artifact instead.
+    Cache* cache = NULL;
+    CacheKey key = { 0 };
+    // Piped assembly never exists as a file, so there is nothing to cache.
+    if (cacheDirectory && !dumpTokens && !dumpAST && !dumpIR && !assemblerCommand) {
+        cache = openCache(cacheDirectory, cacheLimit);
+        if (!cache) {
+            fprintf(stderr, "%s: could not open cache '%s'\n", programName, cacheDirectory);
+        }
+    }
+    if (cache) {
+        const char* options = emitAssembly ? (compileOnly ? "asm object" : "asm") : (compileOnly ? "object" : "executable");
+        key = cacheKey(source->Data, source->Length, options);
+        uint64_t lookupStart = currentNanoseconds();
+        bool hit = fetchCached(cache, key, artifactPath, !emitAssembly && !compileOnly);
+        if (printStatistics) {
+            fprintf(stderr, "Cache: %s, %.3f ms\n", hit ? "hit" : "miss", (currentNanoseconds() - lookupStart) / 1e6);
+        }
+        if (hit) {
+            freeCache(cache);
+            free(generatedAsmPath);
+            freeSourceBuffer(source);
+            return 0;
+        }
+    }
+
+    // The assembler starts up while the source is compiled and reads the assembly as it is generated.
+    pid_t assembler = -1;
+    int assemblerInput = -1;
+    if (assemblerCommand && !dumpTokens && !dumpAST && !dumpIR) {
+        char* shell[] = { "/bin/sh", "-c", (char*)assemblerCommand, NULL };
+        assembler = spawnPipedProcess(shell, &assemblerInput);
+        if (assembler < 0) {
+            fprintf(stderr, "%s: could not start '%s'\n", programName, assemblerCommand);
+            return 1;
+        }
+        // An assembler that quits early makes writes fail rather than kill the compiler.
+        signal(SIGPIPE, SIG_IGN);
+    }
+    int exitStatus = 0;
+
+    // The token dump needs every token at once, so it always lexes up front.
+    streamTokens = streamTokens && !dumpTokens;
 
-    const char* file = readFile(inputFilePath);
-    printf("%s:\n%s\n", inputFilePath, file);
+    ThreadPool* pool = threadCount > 1 ? newThreadPool(threadCount) : NULL;
 
-    Lexer* lexer = newLexer(file);
-    Token* tokens = scanTokens(lexer);
-    //printTokens(lexer);
+    uint64_t lexingStart = currentNanoseconds();
+    Lexer* lexer = NULL;
+    TokenStream* tokens = NULL;
+    if (streamTokens) {
+        lexer = newStreamingLexer(source->Data, source->Length, streamingTokenCapacity);
+    } else {
+        lexer = newLexer(source->Data, source->Length);
+        tokens = pool ? scanTokensParallel(lexer, pool) : scanTokens(lexer);
+    }
+    uint64_t lexingEnd = currentNanoseconds();
+
+    if (printStatistics && !streamTokens) {
+        double lexingSeconds = (lexingEnd - lexingStart) / 1e9;
+        fprintf(stderr, "Lexing: %.3f ms, %u tokens (%.1f MB), %.1f MB/s (%s, %u threads)\n",
+            lexingSeconds * 1e3, tokens->Count, tokenStreamSize(tokens) / 1e6, source->Length / 1e6 / lexingSeconds,
+            lexer->Kernels->Name, threadCount);
+    }
+    if (dumpTokens) {
+        printTokens(lexer);
+        freeThreadPool(pool);
+        freeLexer(lexer);
+        freeSymbols();
+        freeSourceBuffer(source);
+        return 0;
+    }
+
+    // Programs have roughly one node for every two tokens.
+    Ast* ast = newAst(streamTokens ? source->Length / 8 : tokens->Count / 2);
+    Parser* parser = streamTokens ? newStreamingParser(lexer, ast) : newParser(tokens, ast);
+    // Building a program only needs the functions reachable from main; the dumps and objects need every body.
+    // Skipped bodies are parsed from their tokens later, which a token ring doesn't keep.
+    parser->LazyBodies = !dumpAST && !dumpIR && !streamTokens && !compileOnly;
+    NodeIndex program = pool ? parseParallel(parser, pool) : parse(parser);
+    uint32_t skippedBodies = parser->SkippedBodies;
+    uint32_t reachedBodies = parser->LazyBodies ? parseReachableFunctions(parser, intern("main", 4)) : 0;
+    uint64_t parsingEnd = currentNanoseconds();
+
+    if (dumpAST) {
+        dumpNode(stdout, ast, program);
+    } else if (dumpIR) {
+        NodeIndex* functions = newStretchyBuffer(sizeof(NodeIndex));
+        collectFunctions(ast, program, &functions);
+        IrFunction* function = newIrFunction();
+        for (size_t i = 0; i < bufferLength(functions); i++) {
+            lowerFunction(function, ast, functions[i]);
+            dumpIr(stdout, function);
+            char message[256];
+            if (!verifyIr(function, message, sizeof(message))) {
+                fprintf(stderr, "%s: invalid IR in '%s': %s\n", programName, symbolName(function->Name), message);
+                exitStatus = 1;
+            }
+        }
+        freeIrFunction(function);
+        freeStretchyBuffer(functions);
+    } else {
+        Generator* generator = newGenerator(emitAssembly ? EMITTER_ASSEMBLY : EMITTER_MACHINE_CODE);
+        if (assembler >= 0) {
+            streamEmitter(generator->Output, assemblerInput);
+        }
+        if (!compileOnly) {
+            generateRuntime(generator);
+        }
+        if (pool) {
+            generateParallel(generator, ast, program, pool);
+        } else {
+            generate(generator, ast, program);
+        }
 
-    sh("echo", "hello");
+        const char* undefined = NULL;
+        bool written = false;
+        if (assembler >= 0) {
+            written = flushEmitter(generator->Output);
+            close(assemblerInput);
+            int assemblerStatus = waitProcess(assembler);
+            if (assemblerStatus != 0) {
+                fprintf(stderr, "%s: '%s' failed with status %d\n", programName, assemblerCommand, assemblerStatus);
+                exitStatus = 1;
+            }
+        } else if (emitAssembly) {
+            written = writeEmitter(generator->Output, generatedAsmPath);
+        } else if (compileOnly) {
+            written = writeObject(generator->Output, fileOutputPath);
+        } else if (!resolveSymbols(generator->Output, &undefined)) {
+            fprintf(stderr, "%s: undefined function '%s'\n", programName, undefined);
+        } else {
+            written = writeExecutable(generator->Output, "_start", fileOutputPath);
+        }
+        if (!written && assembler >= 0) {
+            fprintf(stderr, "%s: could not pipe assembly to '%s'\n", programName, assemblerCommand);
+        } else if (!written && !undefined) {
+            fprintf(stderr, "%s: could not write '%s'\n", programName, artifactPath);
+        }
+        if (!written) {
+            exitStatus = 1;
+        }
+        if (written && cache) {
+            storeCached(cache, key, artifactPath);
+        }
+        freeGenerator(generator);
+    }
+    uint64_t generatingEnd = currentNanoseconds();
 
-    /*
-    const char* generatedAsmPath = strcat(strcpy(calloc(strlen(fileOutputPath) + strlen(asmExtension) + 1, sizeof(char)), fileOutputPath), asmExtension);
+    if (printStatistics) {
+        if (streamTokens) {
+            fprintf(stderr, "Lexing and parsing: %.3f ms, %u tokens (%.1f KB ring)\n",
+                (parsingEnd - lexingStart) / 1e6, lexer->Tokens->Count, tokenStreamSize(lexer->Tokens) / 1e3);
+        } else {
+            fprintf(stderr, "Parsing: %.3f ms, %u of %u skipped function bodies reachable\n",
+                (parsingEnd - lexingEnd) / 1e6, reachedBodies, skippedBodies);
+        }
+        if (!dumpAST && !dumpIR) {
+            fprintf(stderr, "Generating: %.3f ms\n", (generatingEnd - parsingEnd) / 1e6);
+        }
+        printAstStatistics(stderr, ast);
+        printSymbolStatistics(stderr);
+    }
 
-    Parser* parser = newParser(tokens);
-    Node* program = parse(parser);
-    Generator* generator = newGenerator(generatedAsmPath);
-    generate(generator, program);
-    */
+    for (size_t i = 0; i < bufferLength(inputPaths); i++) {
+        free(inputPaths[i]);
+    }
+    freeStretchyBuffer(inputPaths);
+    freeStretchyBuffer(sharedOptions);
+    freeCache(cache);
+    free(generatedAsmPath);
+    freeThreadPool(pool);
+    freeParser(parser);
+    freeAst(ast);
+    freeLexer(lexer);
+    freeSymbols();
+    freeSourceBuffer(source);
+    return exitStatus;
 }
 
 void usage(const char* programName) {
     printf("Nash is a compiled language with its main influences being C, Typescript, and Lua.\n");
     printf("%s <command> arguments...\n", programName);
     printf("Commands:\n");
+    printf("tokens\t\tDisplays the tokens of a given nash program.\n");
     printf("ast\t\tDisplays the abstract syntax tree of a given nash program.\n");
-    printf("build\t\tCompiles given nash files.\n");
+    printf("ir\t\tDisplays the intermediate representation of a given nash program.\n");
+    printf("build\t\tCompiles given nash files, or those listed in @<manifest>, into one executable.\n");
+    printf("runtime\t\tWrites the runtime object that objects built with -c are linked with.\n");
+    printf("link\t\tLinks the given objects into an executable.\n");
+    printf("cache\t\tReports the hits, misses and size of the given cache directory and trims it to its limit.\n");
     printf("help\t\tDisplay this help message.\n");
+    printf("Options:\n");
+    printf("-o <path>\tWrite output to the given path.\n");
+    printf("--stats\t\tReport phase timings and memory statistics after compiling.\n");
+    printf("-j <count>\tUse up to <count> threads, or compile up to <count> inputs at once.\n");
+    printf("-c\t\tWrite a relocatable object instead of an executable.\n");
+    printf("--cache <dir>\tReuse artifacts of identical earlier builds stored in <dir>.\n");
+    printf("--cache-limit <size>\tEvict the least recently used artifacts past <size> bytes (K, M or G; 256M by default).\n");
+    printf("--assembler <command>\tPipe the assembly into <command>'s standard input while it is generated.\n");
+    printf("--asm\t\tWrite NASM assembly to <path>.asm instead of building an executable.\n");
+    printf("--stream\t\tLex on demand while parsing instead of lexing the whole file first.\n");
+    printf("--simd=<set>\tLex with the scalar, sse2 or avx2 kernels instead of the best supported ones.\n");
 }
 